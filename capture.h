@@ -0,0 +1,55 @@
+/*
+ * Frame capture stream format
+ *
+ * Shared by the firmware (encoder, main.c) and the host decoder
+ * (tools/capture_decode.c). Every LED is described by a 4-bit shade code:
+ * the palette index in bits 0..2 and CAP_SHADE_BRIGHT in bit 3 when the LED
+ * is drawn from palette_bright instead of palette.
+ *
+ *   keyframe := CAP_KEY  seq n_leds packed[(n_leds + 1) / 2] crc
+ *   delta    := CAP_DELTA seq record* CAP_END crc
+ *   record   := start count packed[(count + 1) / 2]
+ *
+ * `seq` increments by one per frame so the host can spot dropped frames.
+ * `crc` is the CRC-8 (cap_crc8_update) of the frame's bytes after the marker,
+ * CAP_END excluded. Every byte other than the three markers is stuffed: a
+ * value >= CAP_ESC goes out as CAP_ESC, value ^ CAP_ESC_XOR, so a marker on
+ * the wire always starts or ends a frame and a decoder that joins mid-stream
+ * or drops a byte resynchronises at the next one.
+ * Shade codes are packed two per byte, high nibble first. A delta only
+ * carries the LEDs that changed since the previous frame; short unchanged
+ * gaps are folded into the surrounding record because a new record costs
+ * two header bytes. A keyframe is sent every CAP_KEYFRAME_INTERVAL frames
+ * so a decoder that joins late (or lost bytes) resynchronises quickly.
+ */
+
+#ifndef CAPTURE_H_
+#define CAPTURE_H_
+
+#include <stdint.h>
+
+#define CAP_KEY                0xFE
+#define CAP_DELTA              0xFD
+#define CAP_END                0xFF
+#define CAP_ESC                0xFC
+#define CAP_ESC_XOR            0x20
+
+#define CAP_SHADE_BRIGHT       0x08
+#define CAP_SHADE_INDEX        0x07
+
+#define CAP_KEYFRAME_INTERVAL  64   // frames between keyframes
+#define CAP_MERGE_GAP          3    // unchanged LEDs folded into one record
+
+/* CRC-8, polynomial 0x07, initial value 0 */
+#ifdef __AVR__
+#include <util/crc16.h>
+#define cap_crc8_update(crc, b) _crc8_ccitt_update(crc, b)
+#else
+static inline uint8_t cap_crc8_update(uint8_t crc, uint8_t b) {
+    crc ^= b;
+    for (uint8_t i = 0; i < 8; i++) crc = (uint8_t)((crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1);
+    return crc;
+}
+#endif
+
+#endif /* CAPTURE_H_ */
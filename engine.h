@@ -0,0 +1,139 @@
+/*
+ * Match engine
+ *
+ * The rules shared by the firmware (main.c) and the Linux match server
+ * (tools/logik_server.c). Two players guess the same secret, one row each
+ * per turn, and both rows of a turn are scored together; the first to place
+ * every peg wins, both at once is a winning draw, and running out of turns
+ * is a losing draw. Everything a match needs lives in one Match, so the
+ * device keeps a single one and the server thousands.
+ *
+ * Rows are in canonical column order (0..CODE_LEN-1 from Player 1's side);
+ * the device mirrors Player 2's selection slots before committing.
+ */
+
+#ifndef ENGINE_H_
+#define ENGINE_H_
+
+#include <stdint.h>
+
+#define N_PLAYERS   2
+#define N_TURNS     6
+#define CODE_LEN    4
+#define CODE_PACKED ((CODE_LEN + 1) / 2)            // two pegs per byte
+#define COLOR_COUNT 6                               // classic variant
+
+/* Game variants, listed once. The index is the one the device keeps in its
+ * checkpoint and a client sends in JOIN. The device builds its per-variant
+ * paths from this list; the server keeps no turn clock and hosts the
+ * untimed entries only. Colours fit a nibble (pack_code()).
+ *
+ *        id        colours         unique  turn_s */
+#define VARIANTS(X)                             \
+    X(CLASSIC,      COLOR_COUNT,    0,  0)      \
+    X(WIDE,         7,              0,  0)      \
+    X(UNIQUE,       COLOR_COUNT,    1,  0)      \
+    X(TIMED,        COLOR_COUNT,    0,  30)
+
+#define VARIANT_ENUM(id, colors, unique, turn_s) VARIANT_##id,
+typedef enum { VARIANTS(VARIANT_ENUM) VARIANT_COUNT } VariantId;
+
+typedef struct {
+    uint8_t colors;             // secret colours are 1..colors
+    uint8_t unique;             // secret never repeats a colour
+    uint8_t turn_seconds;       // 0: untimed
+} VariantRules;
+
+#define VARIANT_RULES(id, colors, unique, turn_s) [VARIANT_##id] = { colors, unique, turn_s },
+static const VariantRules variant_rules[VARIANT_COUNT] = { VARIANTS(VARIANT_RULES) };
+
+#include "rng.h"
+#include "feedback.h"
+
+typedef struct {
+    uint8_t guess[CODE_LEN];
+    uint8_t n_pos;
+    uint8_t n_col;
+    uint8_t committed;
+} Turn;
+
+typedef struct {
+    Turn turns[N_TURNS];
+} Board;
+
+typedef enum { GS_PLAYING, GS_P1_WIN, GS_P2_WIN, GS_DRAW } GameState;
+
+typedef struct {
+    Board boards[N_PLAYERS];
+    uint8_t secret[CODE_LEN];
+    uint8_t current_turn;       // row being entered; stays on the last row once over
+    GameState game_state;
+    uint8_t draw_winning;       // GS_DRAW: both solved it on the same turn
+    uint8_t colors;             // secret colours are 1..colors
+    uint8_t unique;             // secret never repeats a colour
+} Match;
+
+/* Code packing used by the checkpoint and the match protocol */
+static inline void pack_code(uint8_t out[CODE_PACKED], const uint8_t code[CODE_LEN]) {
+    for (uint8_t i = 0; i < CODE_PACKED; i++) out[i] = 0;
+    for (uint8_t i = 0; i < CODE_LEN; i++) out[i >> 1] |= (i & 1) ? code[i] : (uint8_t)(code[i] << 4);
+}
+
+static inline void unpack_code(uint8_t code[CODE_LEN], const uint8_t in[CODE_PACKED]) {
+    for (uint8_t i = 0; i < CODE_LEN; i++) code[i] = (i & 1) ? (in[i >> 1] & 0x0F) : (in[i >> 1] >> 4);
+}
+
+static inline void draw_secret(uint8_t out[CODE_LEN], Rng *rng, uint8_t colors, uint8_t unique) {
+    uint8_t used = 0;
+    for (uint8_t i = 0; i < CODE_LEN; ++i) {
+        uint8_t c;
+        do {
+            c = rng_below(rng, colors) + 1;         // values 1..colors inclusive
+        } while (unique && (used & (1 << c)));
+        used |= 1 << c;
+        out[i] = c;
+    }
+}
+
+/* Clears the boards and draws a new secret */
+static inline void match_start(Match *m, Rng *rng, uint8_t colors, uint8_t unique) {
+    for (uint8_t p = 0; p < N_PLAYERS; p++) {
+        for (uint8_t t = 0; t < N_TURNS; t++) {
+            Turn *turn = &m->boards[p].turns[t];
+            turn->n_pos = turn->n_col = turn->committed = 0;
+            for (uint8_t i = 0; i < CODE_LEN; i++) turn->guess[i] = 0;
+        }
+    }
+    m->colors = colors;
+    m->unique = unique;
+    draw_secret(m->secret, rng, colors, unique);
+    m->current_turn = 0;
+    m->game_state = GS_PLAYING;
+    m->draw_winning = 0;
+}
+
+/* Commits and scores both players' rows for the current turn and moves on
+ * to the next one while the match is still being played. */
+static inline GameState match_commit(Match *m, const uint8_t row0[CODE_LEN],
+                                     const uint8_t row1[CODE_LEN]) {
+    const uint8_t *rows[N_PLAYERS] = { row0, row1 };
+    uint8_t solved = 0;
+    for (uint8_t p = 0; p < N_PLAYERS; p++) {
+        Turn *turn = &m->boards[p].turns[m->current_turn];
+        for (uint8_t i = 0; i < CODE_LEN; i++) turn->guess[i] = rows[p][i];
+        compute_feedback(m->secret, turn->guess, &turn->n_pos, &turn->n_col);
+        turn->committed = 1;
+        if (turn->n_pos == CODE_LEN) solved |= 1 << p;
+    }
+
+    if (solved == 3) { m->game_state = GS_DRAW; m->draw_winning = 1; }
+    else if (solved == 1) m->game_state = GS_P1_WIN;
+    else if (solved == 2) m->game_state = GS_P2_WIN;
+    else if (m->current_turn == (N_TURNS - 1)) m->game_state = GS_DRAW;
+    else m->game_state = GS_PLAYING;
+
+    if (m->game_state == GS_PLAYING) m->current_turn++;
+    return m->game_state;
+}
+
+#endif /* ENGINE_H_ */
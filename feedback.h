@@ -0,0 +1,79 @@
+/*
+ * Feedback kernel
+ *
+ * Shared by the firmware (main.c) and the host benchmark
+ * (tools/bench_feedback.c). Scores a guess against a secret the way the
+ * original two-pass compute_feedback() did: an exact match needs a
+ * non-empty peg, and colour 0 (an empty peg) never scores as a colour.
+ *
+ * Exact matches: both codes are packed into 16 bits, one peg per nibble;
+ * adding 7 to a nibble of (guess ^ secret) or of guess sets its bit 3
+ * exactly when the nibble is non-zero. Colour matches: each peg adds a
+ * table entry with a 1 in its colour's nibble, giving 8 counts per code in a
+ * uint32_t, and min(secret, guess) per colour is picked with a guard-bit
+ * subtract. Summed over colours 1..7 that is exact + colour-only matches.
+ *
+ * No loops or branches depend on the pegs, so a call takes the same number
+ * of cycles for every guess and secret.
+ */
+
+#ifndef FEEDBACK_H_
+#define FEEDBACK_H_
+
+#include <stdint.h>
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#else
+#define PROGMEM
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+#endif
+
+#define FB_CODE_LEN   4
+#define FB_MAX_COLOR  7                 // colours are palette indices 0..7
+#define FB_GUARD      0x88888888UL      // bit 3 of every nibble
+
+#if defined(CODE_LEN) && CODE_LEN != FB_CODE_LEN
+#error "feedback.h packs exactly FB_CODE_LEN pegs"
+#endif
+
+/* One count in colour c's nibble */
+static const uint32_t fb_count_one[FB_MAX_COLOR + 1] PROGMEM = {
+    0x00000001UL, 0x00000010UL, 0x00000100UL, 0x00001000UL,
+    0x00010000UL, 0x00100000UL, 0x01000000UL, 0x10000000UL,
+};
+
+static inline uint16_t fb_pack(const uint8_t c[FB_CODE_LEN]) {
+    return (uint16_t)(c[0] | c[1] << 4) | (uint16_t)(c[2] | c[3] << 4) << 8;
+}
+
+static inline uint32_t fb_counts(const uint8_t c[FB_CODE_LEN]) {
+    return pgm_read_dword(&fb_count_one[c[0]]) + pgm_read_dword(&fb_count_one[c[1]]) +
+           pgm_read_dword(&fb_count_one[c[2]]) + pgm_read_dword(&fb_count_one[c[3]]);
+}
+
+static inline void compute_feedback(const uint8_t secret_[FB_CODE_LEN],
+                                    const uint8_t guess [FB_CODE_LEN],
+                                    uint8_t *n_pos, uint8_t *n_col)
+{
+    /* Exact: guess peg set and equal to the secret's */
+    uint16_t gp = fb_pack(guess), sp = fb_pack(secret_);
+    uint16_t differ = ((gp ^ sp) + 0x7777) & 0x8888;
+    uint16_t filled = (gp + 0x7777) & 0x8888;
+    uint16_t h = (filled & ~differ) >> 3;           // one bit per exact peg
+    h += h >> 8;
+    h += h >> 4;
+    uint8_t pos = h & 0x0F;
+
+    /* Shared colours: per-nibble min of the two count vectors */
+    uint32_t s = fb_counts(secret_), g = fb_counts(guess);
+    uint32_t ge = (((s | FB_GUARD) - g) & FB_GUARD) >> 3;  // 1 where s >= g
+    uint32_t pick_g = (ge << 4) - ge;                       // 0xF where s >= g
+    uint32_t m = ((g & pick_g) | (s & ~pick_g)) & ~0x0FUL;  // colour 0 never scores
+    m = (m & 0x0F0F0F0FUL) + ((m >> 4) & 0x0F0F0F0FUL);
+    uint8_t shared = (uint8_t)m + (uint8_t)(m >> 8) + (uint8_t)(m >> 16) + (uint8_t)(m >> 24);
+
+    *n_pos = pos;
+    *n_col = shared - pos;
+}
+
+#endif /* FEEDBACK_H_ */
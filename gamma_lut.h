@@ -0,0 +1,67 @@
+/*
+ * Gamma 2.2 LUTs for 32 perceptual levels at 8 brightness steps, as
+ * 8.8 fixed-point strip values for ws2812_setleds_lut().
+ * Generated by tools/gen_gamma.c -- do not edit.
+ */
+
+#ifndef GAMMA_LUT_H_
+#define GAMMA_LUT_H_
+
+#include <avr/pgmspace.h>
+
+#define GAMMA_LEVELS        32
+#define BRIGHTNESS_STEPS    8
+#define BRIGHTNESS_DEFAULT  4
+
+static const uint16_t gamma_lut[BRIGHTNESS_STEPS][GAMMA_LEVELS] PROGMEM = {
+    {   // peak 6.3
+        0x0000, 0x0001, 0x0004, 0x0009, 0x0012, 0x001D, 0x002C, 0x003D,
+        0x0052, 0x006B, 0x0086, 0x00A6, 0x00C9, 0x00EF, 0x011A, 0x0148,
+        0x017A, 0x01B0, 0x01E9, 0x0227, 0x0269, 0x02AF, 0x02F9, 0x0347,
+        0x0399, 0x03F0, 0x044B, 0x04AA, 0x050E, 0x0575, 0x05E2, 0x0652,
+    },
+    {   // peak 9.5
+        0x0000, 0x0001, 0x0006, 0x000E, 0x001B, 0x002C, 0x0041, 0x005C,
+        0x007B, 0x00A0, 0x00C9, 0x00F8, 0x012D, 0x0167, 0x01A6, 0x01EB,
+        0x0236, 0x0287, 0x02DE, 0x033B, 0x039E, 0x0406, 0x0475, 0x04EB,
+        0x0566, 0x05E8, 0x0670, 0x06FF, 0x0794, 0x0830, 0x08D2, 0x097B,
+    },
+    {   // peak 14.2
+        0x0000, 0x0002, 0x0009, 0x0015, 0x0028, 0x0042, 0x0062, 0x008A,
+        0x00B9, 0x00F0, 0x012E, 0x0175, 0x01C3, 0x021A, 0x0279, 0x02E1,
+        0x0352, 0x03CB, 0x044D, 0x04D8, 0x056C, 0x060A, 0x06B0, 0x0760,
+        0x0819, 0x08DC, 0x09A9, 0x0A7F, 0x0B5E, 0x0C48, 0x0D3B, 0x0E39,
+    },
+    {   // peak 21.3
+        0x0000, 0x0003, 0x000D, 0x0020, 0x003C, 0x0063, 0x0093, 0x00CF,
+        0x0115, 0x0167, 0x01C5, 0x022F, 0x02A5, 0x0327, 0x03B6, 0x0452,
+        0x04FB, 0x05B0, 0x0674, 0x0744, 0x0822, 0x090E, 0x0A08, 0x0B10,
+        0x0C26, 0x0D4A, 0x0E7D, 0x0FBE, 0x110E, 0x126C, 0x13D9, 0x1555,
+    },
+    {   // peak 32.0
+        0x0000, 0x0004, 0x0014, 0x0030, 0x005B, 0x0094, 0x00DD, 0x0136,
+        0x01A0, 0x021B, 0x02A8, 0x0346, 0x03F7, 0x04BB, 0x0591, 0x067B,
+        0x0778, 0x0889, 0x09AD, 0x0AE6, 0x0C34, 0x0D96, 0x0F0C, 0x1098,
+        0x1239, 0x13EF, 0x15BB, 0x179D, 0x1995, 0x1BA2, 0x1DC6, 0x2000,
+    },
+    {   // peak 48.0
+        0x0000, 0x0006, 0x001E, 0x0048, 0x0088, 0x00DE, 0x014B, 0x01D1,
+        0x0270, 0x0329, 0x03FC, 0x04EA, 0x05F3, 0x0718, 0x085A, 0x09B8,
+        0x0B34, 0x0CCD, 0x0E84, 0x1059, 0x124D, 0x1460, 0x1693, 0x18E4,
+        0x1B56, 0x1DE7, 0x2099, 0x236B, 0x265F, 0x2973, 0x2CA9, 0x3000,
+    },
+    {   // peak 72.0
+        0x0000, 0x000A, 0x002C, 0x006C, 0x00CC, 0x014D, 0x01F1, 0x02BA,
+        0x03A8, 0x04BD, 0x05FA, 0x075E, 0x08EC, 0x0AA4, 0x0C87, 0x0E94,
+        0x10CE, 0x1333, 0x15C6, 0x1886, 0x1B74, 0x1E91, 0x21DC, 0x2556,
+        0x2900, 0x2CDB, 0x30E6, 0x3521, 0x398E, 0x3E2D, 0x42FD, 0x4800,
+    },
+    {   // peak 108.0
+        0x0000, 0x000E, 0x0043, 0x00A2, 0x0132, 0x01F3, 0x02EA, 0x0417,
+        0x057C, 0x071C, 0x08F6, 0x0B0E, 0x0D63, 0x0FF6, 0x12CA, 0x15DE,
+        0x1935, 0x1CCD, 0x20A9, 0x24C9, 0x292E, 0x2DD9, 0x32CA, 0x3801,
+        0x3D81, 0x4348, 0x4958, 0x4FB2, 0x5655, 0x5D43, 0x647C, 0x6C00,
+    },
+};
+
+#endif /* GAMMA_LUT_H_ */
@@ -1,14 +1,31 @@
 #define F_CPU 16000000UL
+#include <stddef.h>
 #include <util/delay.h>
 #include <avr/io.h>
 #include <avr/eeprom.h>      // for EEPROM boot counter
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <avr/wdt.h>
+#include <util/crc16.h>
 #include "light_ws2812.h"
+#include "capture.h"
+#include "gamma_lut.h"
+#include "engine.h"
 
 #define NUM_LEDS 104
-#define COLOR_COUNT 6
-#define N_PLAYERS   2
-#define N_TURNS     6
-#define CODE_LEN    4
+#define PALETTE_COLORS 7     // colours available to any variant
+
+/* Debug builds (-D...=1): frame capture, input latency, frame profile */
+#ifndef LOGIK_CAPTURE
+#define LOGIK_CAPTURE 0
+#endif
+#ifndef LOGIK_LATENCY
+#define LOGIK_LATENCY 0
+#endif
+#ifndef LOGIK_PROFILE
+#define LOGIK_PROFILE 0
+#endif
+#define LOGIK_DEBUG (LOGIK_CAPTURE || LOGIK_LATENCY || LOGIK_PROFILE)
 
 /* ------------- GRB COLOR REMAP -------------
  * Strip is GRB, but the code was assuming RGB.
@@ -16,19 +33,7 @@
  */
 #define WS2812_COLOR(r,g,b)  ((struct cRGB){ (g), (r), (b) })
 
-typedef struct {
-    uint8_t guess[CODE_LEN];
-    uint8_t n_pos;
-    uint8_t n_col;
-    uint8_t committed;
-} Turn;
-
-typedef struct {
-    Turn turns[N_TURNS];
-} Board;
-
-static Board boards[N_PLAYERS];
-static uint8_t secret[CODE_LEN];
+static Match match;     // boards, secret, turn and state (engine.h)
 
 typedef struct {
     uint8_t guess_led[N_TURNS][CODE_LEN];
@@ -37,11 +42,6 @@ typedef struct {
 
 static LedMap ledmap[N_PLAYERS];
 
-typedef enum { GS_PLAYING, GS_P1_WIN, GS_P2_WIN, GS_DRAW } GameState;
-static uint8_t current_turn = 0;
-static GameState game_state = GS_PLAYING;
-static uint8_t draw_winning = 0;
-
 enum Color {
     COLOR_BLACK = 0,
     COLOR_RED,
@@ -50,20 +50,27 @@ enum Color {
     COLOR_YELLOW,
     COLOR_CYAN,
     COLOR_MAGENTA,
+    COLOR_WHITE,
 };
 
-/* Palettes corrected to GRB via WS2812_COLOR */
-static const struct cRGB palette[COLOR_COUNT+1] = {
+/* Palettes corrected to GRB via WS2812_COLOR. Values are perceptual levels
+ * (0..GAMMA_LEVELS-1); gamma and global brightness are applied by the LUT
+ * at transmit time. At the default brightness levels 22, 16 and 30 come out
+ * as 15.0, 7.5 and 29.8 (gamma_lut.h), the strip values 15, 7 and 30 the
+ * palettes used to hold, with the fractions dithered.
+ */
+static const struct cRGB palette[PALETTE_COLORS+1] = {
     WS2812_COLOR(0, 0, 0),   // BLACK
-    WS2812_COLOR(15,0, 0),   // RED
-    WS2812_COLOR(0, 15,0),   // GREEN
-    WS2812_COLOR(0, 0, 15),  // BLUE
-    WS2812_COLOR(7, 7, 0),   // YELLOW
-    WS2812_COLOR(0, 7, 7),   // CYAN
-    WS2812_COLOR(7, 0, 7),   // MAGENTA
+    WS2812_COLOR(22,0, 0),   // RED
+    WS2812_COLOR(0, 22,0),   // GREEN
+    WS2812_COLOR(0, 0, 22),  // BLUE
+    WS2812_COLOR(16,16,0),   // YELLOW
+    WS2812_COLOR(0, 16,16),  // CYAN
+    WS2812_COLOR(16,0, 16),  // MAGENTA
+    WS2812_COLOR(13,13,13),  // WHITE
 };
 
-static const struct cRGB palette_bright[COLOR_COUNT+1] = {
+static const struct cRGB palette_bright[PALETTE_COLORS+1] = {
     WS2812_COLOR(0, 0, 0),   // BLACK
     WS2812_COLOR(30,0, 0),   // RED
     WS2812_COLOR(0, 30,0),   // GREEN
@@ -71,13 +78,45 @@ static const struct cRGB palette_bright[COLOR_COUNT+1] = {
     WS2812_COLOR(30,30,0),   // YELLOW
     WS2812_COLOR(0, 30,30),  // CYAN
     WS2812_COLOR(30,0, 30),  // MAGENTA
+    WS2812_COLOR(25,25,25),  // WHITE
 };
 
+/* -------------------- Variants -------------------- */
+/* Picked with Player 1's colour pot before each match, from VARIANTS() in
+ * engine.h. Every entry gets its own copy of the per-frame code that depends
+ * on the rules (VARIANT_FUNCS): live colour bucketing, the consistency
+ * search, the turn clock and the evaluation rendering, each built with the
+ * entry's rules as constants. Scoring a commit (compute_feedback() via
+ * match_commit()) does not depend on the rules and is shared.
+ * The board has four peg LEDs per row and shade codes hold a 3-bit palette
+ * index, so variants stay at CODE_LEN pegs and at most PALETTE_COLORS colours.
+ */
+#define VARIANT_FITS(id, colors, unique, turn_s) \
+    _Static_assert(colors <= PALETTE_COLORS, "VARIANT_" #id " has more colours than the palette");
+VARIANTS(VARIANT_FITS)
+
+typedef struct {
+    void (*read_pots)(void);        // cursor slot and live colour
+    void (*check_rows)(void);       // consistency search for both players
+    uint8_t (*turn_expired)(void);
+    void (*render)(void);           // evaluations and turn clock
+} Variant;
+
+static const Variant *variant;
+static uint8_t variant_id = VARIANT_CLASSIC;
+static void select_variant(uint8_t id);
+
+/* A frame is built as shade codes (palette index, optionally | SHADE_BRIGHT)
+ * and only expanded to GRB right before transmitting. */
+#define SHADE_BRIGHT    CAP_SHADE_BRIGHT
+#define BRIGHT(c)       ((c) | SHADE_BRIGHT)
+
 /* Eval peg colors */
 #define EVAL_POS_COLOR  COLOR_RED      // exact position -> red
 #define EVAL_COL_COLOR  COLOR_YELLOW   // color-only     -> yellow
 
 struct cRGB led[NUM_LEDS];
+uint8_t frame[NUM_LEDS];
 uint8_t led_color_codes[NUM_LEDS];
 
 // Cursor and selection
@@ -86,6 +125,7 @@ uint8_t player_2_slot, player_2_led_position, player_2_live_color;
 uint8_t player_1_locked_leds[4];
 uint8_t player_2_locked_leds[4];
 static uint8_t blink_on = 0;
+static uint8_t flag_on = 0;         // 5 Hz flicker for pegs that contradict feedback
 
 // Selection LED order (display indices only)
 static const uint8_t select_led[N_PLAYERS][CODE_LEN] = {
@@ -95,31 +135,65 @@ static const uint8_t select_led[N_PLAYERS][CODE_LEN] = {
 static uint8_t p1_sel_color[4];
 static uint8_t p2_sel_color[4];
 
-/* -------------------- RNG (EEPROM-seeded LCG) -------------------- */
-/* Guarantees different secret on each boot without using ADC. */
+/* -------------------- Reset cause -------------------- */
+/* MCUSR is latched and cleared before main() so a watchdog reset (which
+ * leaves the watchdog running at its shortest timeout) cannot loop.
+ * A power-up with BOD enabled usually sets BORF as well as PORF (the POR
+ * threshold is below VBOT), so power-on and external resets take precedence
+ * over the flags that resume a match. */
+#define RESET_RESUME    ((1 << WDRF) | (1 << BORF))
+#define RESET_FRESH     ((1 << PORF) | (1 << EXTRF))
+
+uint8_t mcusr_mirror __attribute__((section(".noinit")));
+
+void get_mcusr(void) __attribute__((naked, used, section(".init3")));
+void get_mcusr(void) {
+    mcusr_mirror = MCUSR;
+    MCUSR = 0;
+    wdt_disable();
+}
+
+/* -------------------- RNG (entropy pool + xorshift) -------------------- */
+/* The pool is stirred in the background with the ADC bits below the 8 the
+ * game uses (every pot read) and with Timer1's low byte at every button edge.
+ * Human timing at 4 us resolution and pot noise are both unpredictable, and
+ * the boot counter still keeps two boots with identical input apart. Each
+ * new secret folds the pool into the generator (rng.h), so a new game needs
+ * no reboot.
+ */
 static uint32_t EEMEM ee_boot_counter = 0;   // persists across resets
-static uint32_t lcg_state = 1;
+static Rng rng = { 1, 0, 0, 0 };
+static uint16_t entropy_pool;
+static volatile uint8_t edge_jitter;         // stirred by the PCINT2 ISR
+
+static inline void entropy_stir(uint8_t b) {
+    entropy_pool = (entropy_pool << 3 | entropy_pool >> 13) ^ b;
+}
 
-static inline void lcg_seed(uint32_t seed) { lcg_state = seed ? seed : 1; }
-static inline uint16_t lcg16(void) {
-    lcg_state = 1664525UL * lcg_state + 1013904223UL;
-    return (uint16_t)(lcg_state >> 16);
+static inline void entropy_edge(void) {
+    uint8_t j = edge_jitter;
+    edge_jitter = (uint8_t)(j << 1 | j >> 7) ^ TCNT1L;
 }
 
-static uint32_t make_seed(void) {
+#if !LOGIK_LATENCY
+ISR(PCINT2_vect) { entropy_edge(); }         // LOGIK_LATENCY's ISR calls it too
+#endif
+
+static inline void init_entropy(void) {
+    PCMSK2 = (1 << PCINT22) | (1 << PCINT17);   // PD6, PD1
+    PCICR  = (1 << PCIE2);
+}
+
+static void rng_seed_boot(void) {
     uint32_t counter = eeprom_read_dword(&ee_boot_counter);
     eeprom_update_dword(&ee_boot_counter, counter + 1);    // one write per boot
-    uint32_t s = (counter + 1) ^ 0x9E3779B9UL;             // mix with golden-ratio constant
-    s ^= (uint32_t)MCUSR << 24;                            // fold in reset cause
-    MCUSR = 0;                                             // clear it
-    return s ? s : 0xA5A5A5A5UL;
+    rng.z = (uint8_t)counter ^ (uint8_t)(counter >> 16);
+    rng.w = (uint8_t)(counter >> 8) ^ (uint8_t)(counter >> 24);
+    rng_stir(&rng, mcusr_mirror);                          // fold in reset cause
 }
 
-static void generate_secret_random(uint8_t out[CODE_LEN]) {
-    lcg_seed(make_seed());
-    for (uint8_t i = 0; i < CODE_LEN; ++i) {
-        out[i] = (lcg16() % 6) + 1;  // values 1..6 inclusive, repeats allowed
-    }
+static inline void rng_reseed(void) {
+    rng_stir(&rng, entropy_pool ^ ((uint16_t)edge_jitter << 8));
 }
 
 /* -------------------- ADC -------------------- */
@@ -132,55 +206,46 @@ static inline uint8_t read_adc_channel(uint8_t channel) {
     ADMUX = (ADMUX & 0xF0) | (channel & 0x0F);
     ADCSRA |= (1 << ADSC);
     loop_until_bit_is_clear(ADCSRA, ADSC);
+    entropy_stir(ADCL);     // the two noisy LSBs (ADLAR), read before ADCH
     return ADCH;
 }
 static inline uint8_t bucket_floor(uint8_t v, uint8_t n) {
     return ((uint16_t)v * n) >> 8;
 }
 
-/* -------------------- Game logic -------------------- */
-static void compute_feedback(const uint8_t secret_[CODE_LEN],
-                             const uint8_t guess [CODE_LEN],
-                             uint8_t *n_pos, uint8_t *n_col)
-{
-    uint8_t used_s[CODE_LEN] = {0}, used_g[CODE_LEN] = {0};
-    uint8_t pos = 0, col = 0;
-
-    // Exact matches first
-    for (uint8_t i = 0; i < CODE_LEN; i++) {
-        if (guess[i] && guess[i] == secret_[i]) {
-            used_s[i] = used_g[i] = 1;
-            pos++;
-        }
-    }
-    // Color-only matches
-    for (uint8_t i = 0; i < CODE_LEN; i++) {
-        if (used_g[i] || !guess[i]) continue;
-        for (uint8_t j = 0; j < CODE_LEN; j++) {
-            if (used_s[j]) continue;
-            if (guess[i] == secret_[j]) {
-                used_s[j] = 1;
-                col++;
-                break;
-            }
-        }
-    }
+/* -------------------- Timebase -------------------- */
+/* Timer1 free-runs at F_CPU/64 (4 us per tick); its overflow interrupt
+ * extends the count to 32 bits. */
+#define TICK_US           4
+#define TICKS_PER_SECOND  (1000000UL / TICK_US)
+
+static volatile uint16_t ticks_hi = 0;
+
+ISR(TIMER1_OVF_vect) { ticks_hi++; }
 
-    *n_pos = pos;
-    *n_col = col;
+static inline void init_timebase(void) {
+    TCCR1A = 0;
+    TCCR1B = (1 << CS11) | (1 << CS10);             // clk/64
+    TIMSK1 = (1 << TOIE1);
 }
 
-static inline void init_board_state(void) {
-    for (uint8_t p = 0; p < N_PLAYERS; p++) {
-        for (uint8_t t = 0; t < N_TURNS; t++) {
-            boards[p].turns[t].n_pos = boards[p].turns[t].n_col = 0;
-            boards[p].turns[t].committed = 0;
-            for (uint8_t i = 0; i < CODE_LEN; i++) boards[p].turns[t].guess[i] = 0;
-        }
-    }
+static uint32_t ticks_now(void) {
+    uint8_t sreg = SREG;
+    cli();
+    uint16_t lo = TCNT1;
+    uint16_t hi = ticks_hi;
+    if ((TIFR1 & (1 << TOV1)) && lo < 0x8000) hi++;   // overflow not serviced yet
+    SREG = sreg;
+    return ((uint32_t)hi << 16) | lo;
+}
+
+/* -------------------- Game logic -------------------- */
+static uint32_t turn_started;
 
-    /* Generate a fresh random secret: values 1..6, repeats allowed */
-    generate_secret_random(secret);
+static inline void init_board_state(void) {
+    /* Fresh boards and a random secret for the selected variant */
+    rng_reseed();
+    match_start(&match, &rng, variant_rules[variant_id].colors, variant_rules[variant_id].unique);
 
     for (uint8_t i = 0; i < 4; i++) {
         player_1_locked_leds[i] = 0;
@@ -188,20 +253,19 @@ static inline void init_board_state(void) {
         p1_sel_color[i] = COLOR_BLACK;
         p2_sel_color[i] = COLOR_BLACK;
     }
-    current_turn = 0;
-    game_state = GS_PLAYING;
-    draw_winning = 0;
+    turn_started = ticks_now();
 }
 
-static inline void update_player_selections(void) {
+static inline __attribute__((always_inline))
+void update_player_selections(uint8_t colors) {
     player_1_slot = bucket_floor(read_adc_channel(2), 4);
     player_2_slot = bucket_floor(read_adc_channel(4), 4);
-    player_1_led_position = ledmap[0].guess_led[current_turn][player_1_slot];
-    player_2_led_position = ledmap[1].guess_led[current_turn][player_2_slot];
+    player_1_led_position = ledmap[0].guess_led[match.current_turn][player_1_slot];
+    player_2_led_position = ledmap[1].guess_led[match.current_turn][player_2_slot];
 
-    // Colors 1..6 (no black) distributed over the pot range
-    player_1_live_color = bucket_floor(read_adc_channel(3), COLOR_COUNT) + 1;
-    player_2_live_color = bucket_floor(read_adc_channel(5), COLOR_COUNT) + 1;
+    // Colors 1..colors (no black) distributed over the pot range
+    player_1_live_color = bucket_floor(read_adc_channel(3), colors) + 1;
+    player_2_live_color = bucket_floor(read_adc_channel(5), colors) + 1;
 }
 
 static inline uint8_t both_players_locked_row(void) {
@@ -211,68 +275,454 @@ static inline uint8_t both_players_locked_row(void) {
     return all_locked;
 }
 
+/* === After commit, write both rows to guess LEDs in canonical column order ===
+ * (No extra mirroring here; ledmap[1] should already represent columns 0..3
+ *  in the board's canonical left->right.)
+ */
+static void paint_committed_row(uint8_t row) {
+    for (uint8_t col = 0; col < 4; col++) {
+        uint8_t idx0 = ledmap[0].guess_led[row][col];
+        uint8_t idx1 = ledmap[1].guess_led[row][col];
+        led_color_codes[idx0] = match.boards[0].turns[row].guess[col];
+        led_color_codes[idx1] = match.boards[1].turns[row].guess[col];
+    }
+}
+
 static void commit_and_score_turn(void) {
     /* === Store guesses in canonical column order (0..3 from P1 perspective) ===
      * P1: slot s -> col s
      * P2: slot s -> col (3 - s)  [mirror]
      */
+    uint8_t row0[CODE_LEN], row1[CODE_LEN];
     for (uint8_t s = 0; s < 4; s++) {
-        boards[0].turns[current_turn].guess[s] = p1_sel_color[s];
+        row0[s] = p1_sel_color[s];
         uint8_t col1 = (CODE_LEN - 1) - s;  // mirror P2 slots into canonical columns
-        boards[1].turns[current_turn].guess[col1] = p2_sel_color[s];
-    }
-
-    /* === After commit, write both rows to guess LEDs in canonical column order ===
-     * (No extra mirroring here; ledmap[1] should already represent columns 0..3
-     *  in the board's canonical left->right.)
-     */
-    for (uint8_t col = 0; col < 4; col++) {
-        uint8_t idx0 = ledmap[0].guess_led[current_turn][col];
-        uint8_t idx1 = ledmap[1].guess_led[current_turn][col];
-        led_color_codes[idx0] = boards[0].turns[current_turn].guess[col];
-        led_color_codes[idx1] = boards[1].turns[current_turn].guess[col];
+        row1[col1] = p2_sel_color[s];
     }
 
-    /* Score */
-    compute_feedback(secret, boards[0].turns[current_turn].guess,
-                     &boards[0].turns[current_turn].n_pos, &boards[0].turns[current_turn].n_col);
-    compute_feedback(secret, boards[1].turns[current_turn].guess,
-                     &boards[1].turns[current_turn].n_pos, &boards[1].turns[current_turn].n_col);
-
-    boards[0].turns[current_turn].committed = 1;
-    boards[1].turns[current_turn].committed = 1;
-
-    uint8_t p0_win = (boards[0].turns[current_turn].n_pos == CODE_LEN);
-    uint8_t p1_win = (boards[1].turns[current_turn].n_pos == CODE_LEN);
-
-    if (p0_win && p1_win) { game_state = GS_DRAW; draw_winning = 1; }
-    else if (p0_win) game_state = GS_P1_WIN;
-    else if (p1_win) game_state = GS_P2_WIN;
-    else if (current_turn == (N_TURNS - 1)) game_state = GS_DRAW;
-    else game_state = GS_PLAYING;
+    uint8_t row = match.current_turn;
+    match_commit(&match, row0, row1);
+    paint_committed_row(row);
 }
 
-static inline void render_evaluations(void) {
+/* Timed variants show the time left in the current row's eval LEDs */
+#define TIMER_COLOR     COLOR_BLUE
+
+static inline __attribute__((always_inline))
+void render_evaluations(uint8_t turn_seconds) {
     for (uint8_t p = 0; p < N_PLAYERS; p++) {
-        for (uint8_t row = 0; row <= current_turn; row++) {
-            if (!boards[p].turns[row].committed) continue;
-            uint8_t n_pos = boards[p].turns[row].n_pos;
-            uint8_t n_col = boards[p].turns[row].n_col;
+        for (uint8_t row = 0; row <= match.current_turn; row++) {
+            if (!match.boards[p].turns[row].committed) continue;
+            uint8_t n_pos = match.boards[p].turns[row].n_pos;
+            uint8_t n_col = match.boards[p].turns[row].n_col;
             uint8_t peg = 0;
             for (; peg < n_pos && peg < CODE_LEN; peg++) {
                 uint8_t idx = ledmap[p].eval_led[row][peg];
-                led[idx] = palette_bright[EVAL_POS_COLOR];   // bright red
+                frame[idx] = BRIGHT(EVAL_POS_COLOR);   // bright red
             }
             for (; peg < (n_pos + n_col) && peg < CODE_LEN; peg++) {
                 uint8_t idx = ledmap[p].eval_led[row][peg];
-                led[idx] = palette_bright[EVAL_COL_COLOR];   // bright yellow
+                frame[idx] = BRIGHT(EVAL_COL_COLOR);   // bright yellow
             }
             for (; peg < CODE_LEN; peg++) {
                 uint8_t idx = ledmap[p].eval_led[row][peg];
-                led[idx] = palette[COLOR_BLACK];
+                frame[idx] = COLOR_BLACK;
             }
         }
     }
+
+    if (turn_seconds && match.game_state == GS_PLAYING) {
+        uint32_t elapsed = ticks_now() - turn_started;
+        for (uint8_t peg = 0; peg < CODE_LEN; peg++) {
+            // Peg k goes out once k/CODE_LEN of the time is used, from the far end
+            uint32_t off_at = (uint32_t)turn_seconds * TICKS_PER_SECOND * (CODE_LEN - peg) / CODE_LEN;
+            uint32_t on_at  = off_at - (uint32_t)turn_seconds * TICKS_PER_SECOND / CODE_LEN;
+            uint8_t code = COLOR_BLACK;
+            if (elapsed < on_at) code = TIMER_COLOR;
+            else if (elapsed < off_at) code = blink_on ? BRIGHT(TIMER_COLOR) : TIMER_COLOR;
+            for (uint8_t p = 0; p < N_PLAYERS; p++)
+                frame[ledmap[p].eval_led[match.current_turn][peg]] = code;
+        }
+    }
+}
+
+/* -------------------- Checkpoint -------------------- */
+/* The match is checkpointed to EEPROM after every commit so a watchdog or
+ * brownout reset can resume it. Two slots alternate; a slot is valid when its
+ * CRC (written last) matches, and the newer sequence number wins. Bytes are
+ * written from the EEPROM-ready interrupt, so saving never waits on the
+ * 3.3 ms per-byte write time. The ISR and avr-libc's blocking eeprom_* calls
+ * both drive EEAR/EEDR/EECR, so outside boot (before the first checkpoint is
+ * started) those calls wait for the writer with checkpoint_wait() first.
+ */
+#define CKPT_MAGIC    0x4D
+#define CKPT_COMMITTED 0x80
+
+typedef struct {
+    uint8_t guess[CODE_PACKED];
+    uint8_t score;                  // CKPT_COMMITTED | n_pos << 3 | n_col
+} CkptRow;
+
+typedef struct {
+    uint8_t magic;
+    uint8_t seq;
+    uint8_t state;                  // current_turn | game_state << 4 | draw_winning << 7
+    uint8_t variant;
+    uint8_t secret[CODE_PACKED];
+    CkptRow rows[N_PLAYERS][N_TURNS];
+    uint8_t crc;
+} Checkpoint;
+
+static Checkpoint EEMEM ee_ckpt[2];
+static Checkpoint ckpt_image;
+static uint8_t ckpt_slot = 0;                       // slot the next save goes to
+static volatile uint8_t ckpt_pos = sizeof(Checkpoint);  // == sizeof -> idle
+
+ISR(EE_READY_vect) {
+    const uint8_t *src = (const uint8_t *)&ckpt_image;
+    uint16_t dst = (uint16_t)(uintptr_t)&ee_ckpt[ckpt_slot];
+    while (ckpt_pos < sizeof(Checkpoint)) {
+        uint8_t pos = ckpt_pos++;
+        EEAR = dst + pos;
+        EECR |= (1 << EERE);
+        if (EEDR == src[pos]) continue;             // update semantics
+        EEDR = src[pos];
+        EECR |= (1 << EEMPE);
+        EECR |= (1 << EEPE);
+        return;
+    }
+    EECR &= ~(1 << EERIE);
+    ckpt_slot ^= 1;
+}
+
+/* Blocks until a checkpoint being written has reached EEPROM */
+static void checkpoint_wait(void) {
+    while (bit_is_set(EECR, EERIE)) wdt_reset();
+}
+
+static uint8_t ckpt_crc(const Checkpoint *c) {
+    const uint8_t *p = (const uint8_t *)c;
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < offsetof(Checkpoint, crc); i++) crc = _crc8_ccitt_update(crc, p[i]);
+    return crc;
+}
+
+static void checkpoint_save(void) {
+    uint8_t busy = bit_is_set(EECR, EERIE);
+    EECR &= ~(1 << EERIE);                          // keep the ISR off the image
+    if (!busy) ckpt_image.seq++;                    // else rewrite the torn slot
+
+    ckpt_image.magic = CKPT_MAGIC;
+    ckpt_image.state = match.current_turn | (uint8_t)(match.game_state << 4) | (uint8_t)(match.draw_winning << 7);
+    ckpt_image.variant = variant_id;
+    pack_code(ckpt_image.secret, match.secret);
+    for (uint8_t p = 0; p < N_PLAYERS; p++) {
+        for (uint8_t t = 0; t < N_TURNS; t++) {
+            const Turn *turn = &match.boards[p].turns[t];
+            CkptRow *row = &ckpt_image.rows[p][t];
+            pack_code(row->guess, turn->guess);
+            row->score = (turn->committed ? CKPT_COMMITTED : 0) |
+                         (uint8_t)(turn->n_pos << 3) | turn->n_col;
+        }
+    }
+    ckpt_image.crc = ckpt_crc(&ckpt_image);
+
+    ckpt_pos = 0;
+    EECR |= (1 << EERIE);
+}
+
+/* Loads the newest valid slot into ckpt_image so saves continue its
+ * sequence; returns 0 if neither slot is valid. */
+static uint8_t checkpoint_load(void) {
+    Checkpoint slot[2];
+    int8_t best = -1;
+    for (uint8_t i = 0; i < 2; i++) {
+        eeprom_read_block(&slot[i], &ee_ckpt[i], sizeof(Checkpoint));
+        if (slot[i].magic != CKPT_MAGIC || slot[i].crc != ckpt_crc(&slot[i])) continue;
+        if (best < 0 || (int8_t)(slot[i].seq - slot[best].seq) > 0) best = i;
+    }
+    if (best < 0) return 0;
+
+    ckpt_image = slot[best];
+    ckpt_slot = best ^ 1;
+    return 1;
+}
+
+/* Resumes the match held in ckpt_image */
+static uint8_t checkpoint_restore(void) {
+    const Checkpoint *c = &ckpt_image;
+    uint8_t turn = c->state & 0x0F;
+    if (turn >= N_TURNS || c->variant >= VARIANT_COUNT) return 0;
+
+    select_variant(c->variant);
+    match.colors = variant_rules[variant_id].colors;
+    match.unique = variant_rules[variant_id].unique;
+    match.current_turn = turn;
+    turn_started = ticks_now();                     // a timed turn restarts in full
+    match.game_state = (GameState)((c->state >> 4) & 0x03);
+    match.draw_winning = c->state >> 7;
+    unpack_code(match.secret, c->secret);
+    for (uint8_t p = 0; p < N_PLAYERS; p++) {
+        for (uint8_t t = 0; t < N_TURNS; t++) {
+            Turn *dst = &match.boards[p].turns[t];
+            const CkptRow *row = &c->rows[p][t];
+            unpack_code(dst->guess, row->guess);
+            dst->committed = (row->score & CKPT_COMMITTED) ? 1 : 0;
+            dst->n_pos = (row->score >> 3) & 0x07;
+            dst->n_col = row->score & 0x07;
+        }
+    }
+    for (uint8_t t = 0; t < N_TURNS; t++) {
+        if (match.boards[0].turns[t].committed) paint_committed_row(t);
+    }
+
+    /* Winners blink their last row from the selection colours */
+    for (uint8_t s = 0; s < 4; s++) {
+        player_1_locked_leds[s] = 0;
+        player_2_locked_leds[s] = 0;
+        p1_sel_color[s] = COLOR_BLACK;
+        p2_sel_color[s] = COLOR_BLACK;
+        if (match.game_state != GS_PLAYING) {
+            p1_sel_color[s] = match.boards[0].turns[match.current_turn].guess[s];
+            p2_sel_color[s] = match.boards[1].turns[match.current_turn].guess[(CODE_LEN - 1) - s];
+        }
+    }
+    return 1;
+}
+
+/* -------------------- Consistency check -------------------- */
+/* Flags selection LEDs whose peg cannot be in the secret given the feedback
+ * the player already has. For every canonical column and colour the checker
+ * decides whether some code consistent with all committed rows has that
+ * colour there while keeping the player's other locked pegs. The table is
+ * rebuilt when a peg is locked or a row is committed, CONSIST_BUDGET search
+ * steps per player per frame, with the cursor's entry searched first; pot
+ * movements only look it up.
+ *
+ * Each decision is a depth-first search over the columns that keeps every
+ * row's exact and total match counts incrementally and prunes a partial code
+ * as soon as a row has overshot n_pos / n_pos + n_col or can no longer reach
+ * them with the columns left. A code found on the way settles every other
+ * (column, colour) it is a witness for.
+ */
+#define CONSIST_BUDGET  96
+#define CONSIST_IDLE    0xFF
+
+typedef struct {
+    uint8_t fixed[CODE_LEN];        // locked colour per column, 0 = free
+    uint8_t rows;                   // committed rows the table was built for
+    uint8_t known[CODE_LEN];        // bit c: (column, c) decided
+    uint8_t feasible[CODE_LEN];     // bit c: (column, c) fits all feedback
+
+    /* Search in progress, q_col == CONSIST_IDLE when there is none */
+    uint8_t q_col, q_color;
+    uint8_t depth;
+    uint8_t code[CODE_LEN];                     // 0: no colour tried yet
+    uint8_t x_cnt[PALETTE_COLORS + 1];          // colours used by code[0..depth]
+    uint8_t exact[N_TURNS], total[N_TURNS];
+    uint8_t exact_mask[CODE_LEN], total_mask[CODE_LEN];  // rows bumped per depth
+    uint8_t g_cnt[N_TURNS][PALETTE_COLORS + 1]; // colour counts of each guess
+} Consistency;
+
+static Consistency consist[N_PLAYERS] = {   // rows never matches: rebuilt on the first frame
+    { .rows = CONSIST_IDLE }, { .rows = CONSIST_IDLE }
+};
+
+static void consist_start(Consistency *cs, uint8_t col, uint8_t color) {
+    cs->q_col = col;
+    cs->q_color = color;
+    cs->depth = 0;
+    cs->code[0] = 0;
+    for (uint8_t c = 0; c <= PALETTE_COLORS; c++) cs->x_cnt[c] = 0;
+    for (uint8_t r = 0; r < cs->rows; r++) cs->exact[r] = cs->total[r] = 0;
+}
+
+static void consist_reset(Consistency *cs, const Board *b, const uint8_t fixed[CODE_LEN]) {
+    for (uint8_t i = 0; i < CODE_LEN; i++) {
+        cs->fixed[i] = fixed[i];
+        cs->known[i] = cs->feasible[i] = 0;
+    }
+    cs->rows = match.current_turn;
+    for (uint8_t r = 0; r < cs->rows; r++) {
+        for (uint8_t c = 0; c <= PALETTE_COLORS; c++) cs->g_cnt[r][c] = 0;
+        for (uint8_t i = 0; i < CODE_LEN; i++) cs->g_cnt[r][b->turns[r].guess[i]]++;
+    }
+    cs->q_col = CONSIST_IDLE;
+}
+
+/* Next colour to try in column d after `cur`, or 0 when exhausted */
+static inline __attribute__((always_inline))
+uint8_t consist_next(const Consistency *cs, uint8_t d, uint8_t cur,
+                     uint8_t colors, uint8_t unique) {
+    if (d == cs->q_col) return cur ? 0 : cs->q_color;
+    if (cs->fixed[d])   return cur ? 0 : cs->fixed[d];
+    for (uint8_t c = cur + 1; c <= colors; c++) {
+        if (!unique || !cs->x_cnt[c]) return c;
+    }
+    return 0;
+}
+
+/* Places colour c in column d; returns 0 if some row rules the prefix out */
+static inline __attribute__((always_inline))
+uint8_t consist_apply(Consistency *cs, const Board *b, uint8_t d, uint8_t c, uint8_t unique) {
+    uint8_t remaining = (CODE_LEN - 1) - d;
+    uint8_t em = 0, tm = 0, ok = !(unique && cs->x_cnt[c]);
+    for (uint8_t r = 0; r < cs->rows && ok; r++) {
+        const Turn *t = &b->turns[r];
+        if (t->guess[d] == c)               { cs->exact[r]++; em |= 1 << r; }
+        if (cs->x_cnt[c] < cs->g_cnt[r][c]) { cs->total[r]++; tm |= 1 << r; }
+        uint8_t need_t = t->n_pos + t->n_col;
+        if (cs->exact[r] > t->n_pos || cs->exact[r] + remaining < t->n_pos ||
+            cs->total[r] > need_t   || cs->total[r] + remaining < need_t) ok = 0;
+    }
+    cs->x_cnt[c]++;
+    cs->exact_mask[d] = em;
+    cs->total_mask[d] = tm;
+    return ok;
+}
+
+static void consist_undo(Consistency *cs, uint8_t d) {
+    cs->x_cnt[cs->code[d]]--;
+    for (uint8_t r = 0; r < cs->rows; r++) {
+        if (cs->exact_mask[d] & (1 << r)) cs->exact[r]--;
+        if (cs->total_mask[d] & (1 << r)) cs->total[r]--;
+    }
+}
+
+/* A consistent code settles (k, code[k]) for every column k whose other
+ * columns all agree with the locked pegs. */
+static void consist_witness(Consistency *cs) {
+    uint8_t mismatches = 0;
+    for (uint8_t k = 0; k < CODE_LEN; k++)
+        if (cs->fixed[k] && cs->fixed[k] != cs->code[k]) mismatches++;
+    for (uint8_t k = 0; k < CODE_LEN; k++) {
+        uint8_t own = (cs->fixed[k] && cs->fixed[k] != cs->code[k]) ? 1 : 0;
+        if (mismatches - own) continue;
+        uint8_t bit = 1 << cs->code[k];
+        cs->known[k] |= bit;
+        cs->feasible[k] |= bit;
+    }
+}
+
+/* One search step; returns 1 when the current query has been decided */
+static inline __attribute__((always_inline))
+uint8_t consist_step(Consistency *cs, const Board *b, uint8_t colors, uint8_t unique) {
+    uint8_t d = cs->depth;
+    uint8_t cur = cs->code[d];
+    if (cur) consist_undo(cs, d);
+    uint8_t c = consist_next(cs, d, cur, colors, unique);
+    cs->code[d] = c;
+
+    if (!c) {
+        if (d) { cs->depth--; return 0; }
+        cs->known[cs->q_col] |= 1 << cs->q_color;   // exhausted: contradicts feedback
+        return 1;
+    }
+    if (!consist_apply(cs, b, d, c, unique)) return 0;
+    if (d < CODE_LEN - 1) {
+        cs->depth = d + 1;
+        cs->code[d + 1] = 0;
+        return 0;
+    }
+    consist_witness(cs);
+    return 1;
+}
+
+static inline __attribute__((always_inline))
+uint8_t consist_pick(const Consistency *cs, uint8_t *col, uint8_t *color, uint8_t colors) {
+    for (uint8_t k = 0; k < CODE_LEN; k++) {
+        for (uint8_t c = 1; c <= colors; c++) {
+            if (cs->known[k] & (1 << c)) continue;
+            *col = k;
+            *color = c;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Per frame: rebuild on a new lock or row, then spend the step budget.
+ * `locked`/`sel` are the player's slot arrays; `mirror` maps slots to
+ * columns the way commit_and_score_turn() does for Player 2. */
+static inline __attribute__((always_inline))
+void consistency_update(uint8_t p, const uint8_t locked[CODE_LEN], const uint8_t sel[CODE_LEN],
+                        uint8_t mirror, uint8_t cursor_slot, uint8_t cursor_color,
+                        uint8_t colors, uint8_t unique) {
+    Consistency *cs = &consist[p];
+    const Board *b = &match.boards[p];
+
+    uint8_t fixed[CODE_LEN], changed = (cs->rows != match.current_turn);
+    for (uint8_t s = 0; s < CODE_LEN; s++) {
+        uint8_t col = mirror ? (CODE_LEN - 1) - s : s;
+        fixed[col] = locked[s] ? sel[s] : 0;
+    }
+    for (uint8_t k = 0; k < CODE_LEN; k++) changed |= (fixed[k] != cs->fixed[k]);
+    if (changed) consist_reset(cs, b, fixed);
+
+    uint8_t cursor_col = mirror ? (CODE_LEN - 1) - cursor_slot : cursor_slot;
+    if (!(cs->known[cursor_col] & (1 << cursor_color)) &&
+        !(cs->q_col == cursor_col && cs->q_color == cursor_color))
+        consist_start(cs, cursor_col, cursor_color);
+
+    for (uint8_t n = 0; n < CONSIST_BUDGET; n++) {
+        if (cs->q_col == CONSIST_IDLE) {
+            uint8_t col, color;
+            if (!consist_pick(cs, &col, &color, colors)) break;
+            consist_start(cs, col, color);
+        }
+        if (consist_step(cs, b, colors, unique)) cs->q_col = CONSIST_IDLE;
+    }
+}
+
+static inline __attribute__((always_inline))
+void check_rows(uint8_t colors, uint8_t unique) {
+    for (uint8_t p = 0; p < N_PLAYERS; p++) {     // one copy of the search per variant
+        consistency_update(p, p ? player_2_locked_leds : player_1_locked_leds,
+                           p ? p2_sel_color : p1_sel_color, p,
+                           p ? player_2_slot : player_1_slot,
+                           p ? player_2_live_color : player_1_live_color, colors, unique);
+    }
+}
+
+/* 1 once (slot, colour) is known to contradict the player's feedback */
+static inline uint8_t consistency_flagged(uint8_t p, uint8_t mirror, uint8_t slot, uint8_t color) {
+    uint8_t col = mirror ? (CODE_LEN - 1) - slot : slot;
+    uint8_t bit = 1 << color;
+    return (consist[p].known[col] & bit) && !(consist[p].feasible[col] & bit);
+}
+
+/* Expand shade codes to GRB for the strip */
+static inline void expand_frame(void) {
+    for (uint8_t i = 0; i < NUM_LEDS; i++) {
+        uint8_t code = frame[i];
+        led[i] = (code & SHADE_BRIGHT) ? palette_bright[code & CAP_SHADE_INDEX]
+                                       : palette[code];
+    }
+}
+
+/* -------------------- Output -------------------- */
+/* Frames are paced by Timer1 at a fixed rate, fast enough that temporal
+ * dithering of sub-LSB levels does not flicker visibly. led[] holds levels,
+ * turned into strip values per byte inside the WS2812 send loop.
+ */
+#define FRAME_MS            10
+#define FRAME_TICKS         ((uint32_t)FRAME_MS * 1000 / TICK_US)
+#define BLINK_FRAMES        (1000 / FRAME_MS)       // 1 s blink cycle...
+#define BLINK_OFF_FRAMES    (200 / FRAME_MS)        // ...dark for the first 200 ms
+#define FLAG_FRAMES         (100 / FRAME_MS)        // flagged pegs: 100 ms on, 100 ms off
+
+static uint8_t EEMEM ee_brightness = BRIGHTNESS_DEFAULT;
+static uint8_t brightness = BRIGHTNESS_DEFAULT;
+static uint8_t dither_seed = 0;
+
+static void show_frame(void) {
+    expand_frame();
+    ws2812_setleds_lut(led, NUM_LEDS, gamma_lut[brightness], dither_seed);
+    dither_seed += WS2812_DITHER_STEP;
+}
+
+static inline void wait_frame(uint32_t frame_start) {
+    while (ticks_now() - frame_start < FRAME_TICKS) {}
 }
 
 /* LED mapping */
@@ -304,6 +754,419 @@ static inline void init_ledmap(void) {
     }
 }
 
+/* -------------------- Debug channel -------------------- */
+/* PD1 doubles as hardware TXD but is Player 2's button, so the debug
+ * stream is bit-banged on PB1 instead: 8N1, idle high. Commands come in
+ * on the hardware RXD (PD0), with the USART transmitter left disabled.
+ */
+#if LOGIK_DEBUG
+#define DBG_BAUD        115200UL
+#define DBG_BIT_CYCLES  (F_CPU / DBG_BAUD)
+#define DBG_LOOP_CYCLES 9                     // port write + shift + loop per bit
+
+static inline void init_debug(void) {
+    PORTB |= (1 << PB1);
+    DDRB  |= (1 << DDB1);
+
+    UBRR0  = (F_CPU / (8 * DBG_BAUD)) - 1;    // double speed, ~2% error at 16 MHz
+    UCSR0A = (1 << U2X0);
+    UCSR0C = (1 << UCSZ01) | (1 << UCSZ00);   // 8N1
+    UCSR0B = (1 << RXEN0);                    // receive only, PD1 stays a button
+}
+
+static void dbg_putc(uint8_t c) {
+    uint8_t sreg = SREG;
+    cli();                                     // keep bit timing exact
+    PORTB &= ~(1 << PB1);                      // start bit
+    __builtin_avr_delay_cycles(DBG_BIT_CYCLES - DBG_LOOP_CYCLES);
+    for (uint8_t i = 0; i < 8; i++) {
+        if (c & 1) PORTB |= (1 << PB1);
+        else       PORTB &= ~(1 << PB1);
+        c >>= 1;
+        __builtin_avr_delay_cycles(DBG_BIT_CYCLES - DBG_LOOP_CYCLES);
+    }
+    PORTB |= (1 << PB1);                       // stop bit
+    __builtin_avr_delay_cycles(DBG_BIT_CYCLES);
+    SREG = sreg;
+}
+
+static inline void dbg_puts_P(const char *s) {
+    uint8_t c;
+    while ((c = pgm_read_byte(s++))) dbg_putc(c);
+}
+
+static inline void dbg_putu(uint32_t v) {
+    char buf[10];
+    uint8_t n = 0;
+    do { buf[n++] = '0' + (v % 10); v /= 10; } while (v);
+    while (n) dbg_putc(buf[--n]);
+}
+
+/* Single-byte commands, polled once per frame */
+static inline int16_t dbg_getc(void) {
+    if (!(UCSR0A & (1 << RXC0))) return -1;
+    return UDR0;
+}
+#endif
+
+/* -------------------- Frame capture -------------------- */
+#if LOGIK_CAPTURE
+/* Streams the shade codes of every frame as keyframes/deltas (see capture.h)
+ * so tools/capture_decode can mirror the strip on a PC. */
+static uint8_t cap_prev[NUM_LEDS];
+static uint8_t cap_seq = 0;
+static uint8_t cap_until_key = 0;
+static uint8_t cap_crc;
+
+/* Payload byte: stuffed so it never reads as a marker, and added to the CRC */
+static void cap_put(uint8_t b) {
+    cap_crc = cap_crc8_update(cap_crc, b);
+    if (b >= CAP_ESC) {
+        dbg_putc(CAP_ESC);
+        b ^= CAP_ESC_XOR;
+    }
+    dbg_putc(b);
+}
+
+static void capture_send_packed(uint8_t start, uint8_t count) {
+    for (uint8_t i = 0; i < count; i += 2) {
+        uint8_t hi = frame[start + i];
+        uint8_t lo = (i + 1 < count) ? frame[start + i + 1] : 0;
+        cap_put((uint8_t)(hi << 4) | lo);
+    }
+    for (uint8_t i = 0; i < count; i++) cap_prev[start + i] = frame[start + i];
+}
+
+static void capture_frame(void) {
+    cap_crc = 0;
+    if (cap_until_key == 0) {
+        dbg_putc(CAP_KEY);
+        cap_put(cap_seq++);
+        cap_put(NUM_LEDS);
+        capture_send_packed(0, NUM_LEDS);
+        cap_put(cap_crc);
+        cap_until_key = CAP_KEYFRAME_INTERVAL - 1;
+        return;
+    }
+    cap_until_key--;
+
+    dbg_putc(CAP_DELTA);
+    cap_put(cap_seq++);
+    uint8_t i = 0;
+    while (i < NUM_LEDS) {
+        if (frame[i] == cap_prev[i]) { i++; continue; }
+
+        // Grow the record while the next change is within CAP_MERGE_GAP
+        uint8_t last = i;
+        for (uint8_t j = i + 1; j < NUM_LEDS && (uint8_t)(j - last) <= CAP_MERGE_GAP + 1; j++) {
+            if (frame[j] != cap_prev[j]) last = j;
+        }
+        uint8_t count = last - i + 1;
+        cap_put(i);
+        cap_put(count);
+        capture_send_packed(i, count);
+        i = last + 1;
+    }
+    dbg_putc(CAP_END);
+    cap_put(cap_crc);
+}
+#endif
+
+/* -------------------- Latency probe -------------------- */
+/* Button-to-photon latency: the pin-change interrupt timestamps each press
+ * edge on PD6/PD1, the main loop arms the probe once it has acted on the
+ * press, and the probe fires when the next ws2812_setleds_lut() has returned.
+ * Edges during a transmit are seen up to 3.3 ms late (interrupts are off).
+ * Presses the loop then blocks on (the release wait after a row is complete,
+ * the menu after a match) are dropped, so only the render path is measured.
+ *
+ * Debug commands: 'l' reports the histogram, 'r' clears it.
+ */
+#if LOGIK_LATENCY
+#define LAT_BUCKETS        16
+#define LAT_BUCKET_MS      8                        // last bucket is open-ended
+#define LAT_DEBOUNCE_TICKS (5000 / TICK_US)         // ignore presses 5 ms after a release
+#define LAT_STALE_TICKS    (250000UL / TICK_US)     // press never acted on -> missed
+
+static volatile uint32_t lat_edge[N_PLAYERS];
+static volatile uint32_t lat_release[N_PLAYERS];
+static volatile uint8_t  lat_pending = 0;          // bit p: press edge seen
+static uint8_t  lat_armed = 0;                      // bit p: loop acted on it
+
+static uint16_t lat_hist[LAT_BUCKETS];
+static uint16_t lat_count, lat_missed;
+static uint32_t lat_min, lat_max, lat_sum;
+
+static const uint8_t button_pin[N_PLAYERS] = { (1 << PD6), (1 << PD1) };
+
+ISR(PCINT2_vect) {
+    static uint8_t prev = (1 << PD6) | (1 << PD1);
+    uint8_t pins = PIND;
+    uint8_t changed = prev ^ pins;
+    prev = pins;
+    uint32_t now = ticks_now();
+    entropy_edge();
+
+    for (uint8_t p = 0; p < N_PLAYERS; p++) {
+        uint8_t pin = button_pin[p];
+        if (!(changed & pin)) continue;
+        if (pins & pin) {
+            lat_release[p] = now;
+        } else if (!(lat_pending & (1 << p)) &&
+                   now - lat_release[p] > LAT_DEBOUNCE_TICKS) {
+            lat_edge[p] = now;
+            lat_pending |= (1 << p);
+        }
+    }
+}
+
+static void latency_reset(void) {
+    for (uint8_t i = 0; i < LAT_BUCKETS; i++) lat_hist[i] = 0;
+    lat_count = lat_missed = 0;
+    lat_min = UINT32_MAX;
+    lat_max = lat_sum = 0;
+}
+
+static inline void init_latency(void) {
+    latency_reset();        // the pin-change interrupt is already on (init_entropy)
+}
+
+/* Called after polling the buttons, before anything is drawn */
+static void latency_note_input(uint8_t p1_pressed, uint8_t p2_pressed) {
+    uint8_t pressed = (p1_pressed ? 1 : 0) | (p2_pressed ? 2 : 0);
+    uint32_t now = ticks_now();
+
+    cli();
+    lat_armed |= lat_pending & pressed;
+    for (uint8_t p = 0; p < N_PLAYERS; p++) {
+        uint8_t bit = 1 << p;
+        if ((lat_pending & ~lat_armed & ~pressed & bit) &&
+            now - lat_edge[p] > LAT_STALE_TICKS) {
+            lat_pending &= ~bit;                     // tap too short for the loop to see
+            if (lat_missed != UINT16_MAX) lat_missed++;
+        }
+    }
+    sei();
+}
+
+static void latency_record(uint32_t dt) {
+    if (lat_count == UINT16_MAX) return;
+    uint32_t bucket = (dt * TICK_US) / (1000UL * LAT_BUCKET_MS);
+    lat_hist[bucket < LAT_BUCKETS ? bucket : LAT_BUCKETS - 1]++;
+    lat_count++;
+    lat_sum += dt;
+    if (dt < lat_min) lat_min = dt;
+    if (dt > lat_max) lat_max = dt;
+}
+
+/* Called after the loop has blocked on a press, before the next frame */
+static void latency_drop(void) {
+    cli();
+    lat_pending = 0;
+    sei();
+    lat_armed = 0;
+}
+
+/* Called once the frame carrying the change has been sent */
+static void latency_note_output(void) {
+    if (!lat_armed) return;
+    uint32_t now = ticks_now();
+    for (uint8_t p = 0; p < N_PLAYERS; p++) {
+        if (!(lat_armed & (1 << p))) continue;
+        latency_record(now - lat_edge[p]);
+        cli();
+        lat_pending &= ~(1 << p);
+        sei();
+    }
+    lat_armed = 0;
+}
+
+static void latency_report(void) {
+    dbg_puts_P(PSTR("lat n="));      dbg_putu(lat_count);
+    dbg_puts_P(PSTR(" missed="));    dbg_putu(lat_missed);
+    if (lat_count) {
+        dbg_puts_P(PSTR(" min_us="));  dbg_putu(lat_min * TICK_US);
+        dbg_puts_P(PSTR(" mean_us=")); dbg_putu(lat_sum / lat_count * TICK_US);
+        dbg_puts_P(PSTR(" max_us="));  dbg_putu(lat_max * TICK_US);
+    }
+    dbg_putc('\n');
+    for (uint8_t i = 0; i < LAT_BUCKETS; i++) {
+        dbg_puts_P(PSTR("lat "));
+        dbg_putu((uint16_t)i * LAT_BUCKET_MS);
+        dbg_puts_P(i == LAT_BUCKETS - 1 ? PSTR("+ ms ") : PSTR(" ms "));
+        dbg_putu(lat_hist[i]);
+        dbg_putc('\n');
+    }
+}
+#endif
+
+/* -------------------- Frame profile -------------------- */
+/* Time spent per frame between reading the inputs and transmitting (game
+ * logic and rendering, without the wait for a commit's button release), for
+ * comparing variants. Debug command 'p' reports it in CPU cycles and starts
+ * a new sample.
+ */
+#if LOGIK_PROFILE
+#define CYCLES_PER_TICK (F_CPU / TICKS_PER_SECOND)
+
+static uint16_t prof_frames = 0;
+static uint32_t prof_sum = 0, prof_max = 0;
+
+static inline void profile_record(uint32_t ticks) {
+    if (prof_frames == UINT16_MAX) return;
+    prof_frames++;
+    prof_sum += ticks;
+    if (ticks > prof_max) prof_max = ticks;
+}
+
+static void profile_report(void) {
+    dbg_puts_P(PSTR("prof variant=")); dbg_putu(variant_id);
+    dbg_puts_P(PSTR(" frames="));      dbg_putu(prof_frames);
+    if (prof_frames) {
+        dbg_puts_P(PSTR(" mean_cycles=")); dbg_putu(prof_sum / prof_frames * CYCLES_PER_TICK);
+        dbg_puts_P(PSTR(" max_cycles="));  dbg_putu(prof_max * CYCLES_PER_TICK);
+    }
+    dbg_putc('\n');
+    prof_frames = 0;
+    prof_sum = prof_max = 0;
+}
+
+/* Debug command 'f': cycles per compute_feedback() call for every pair of
+ * the probe codes, each timed over FB_PROBE_CALLS calls less the empty loop.
+ * Equal min and max show the cost does not depend on the pegs. */
+#define FB_PROBE_CALLS  64
+
+static uint8_t fb_probe[][CODE_LEN] = {     // not const: reloaded every call
+    {0, 0, 0, 0}, {1, 1, 2, 2}, {6, 5, 4, 3}, {7, 7, 7, 7}, {3, 0, 3, 1},
+};
+#define FB_PROBES (sizeof fb_probe / sizeof fb_probe[0])
+static volatile uint8_t fb_sink;
+
+static uint32_t time_feedback(const uint8_t *s, const uint8_t *g, uint8_t run) {
+    uint8_t n_pos, n_col;
+    uint32_t t0 = ticks_now();
+    for (uint8_t n = 0; n < FB_PROBE_CALLS; n++) {
+        __asm__ __volatile__("" ::: "memory");
+        if (run) {
+            compute_feedback(s, g, &n_pos, &n_col);
+            fb_sink = n_pos + n_col;
+        }
+    }
+    return ticks_now() - t0;
+}
+
+static void profile_feedback(void) {
+    uint32_t lo = UINT32_MAX, hi = 0;
+    uint32_t empty = time_feedback(fb_probe[0], fb_probe[0], 0);
+    for (uint8_t a = 0; a < FB_PROBES; a++) {
+        for (uint8_t b = 0; b < FB_PROBES; b++) {
+            uint32_t t = time_feedback(fb_probe[a], fb_probe[b], 1) - empty;
+            if (t < lo) lo = t;
+            if (t > hi) hi = t;
+        }
+    }
+    dbg_puts_P(PSTR("feedback min_cycles=")); dbg_putu(lo * CYCLES_PER_TICK / FB_PROBE_CALLS);
+    dbg_puts_P(PSTR(" max_cycles="));         dbg_putu(hi * CYCLES_PER_TICK / FB_PROBE_CALLS);
+    dbg_putc('\n');
+}
+#endif
+
+/* -------------------- Turn flow -------------------- */
+static void finish_turn(void) {
+    commit_and_score_turn();
+    if (match.game_state == GS_PLAYING) {
+        turn_started = ticks_now();
+        for (uint8_t i = 0; i < 4; i++) {
+            player_1_locked_leds[i] = 0;
+            player_2_locked_leds[i] = 0;
+            p1_sel_color[i] = COLOR_BLACK;
+            p2_sel_color[i] = COLOR_BLACK;
+        }
+    }
+    checkpoint_save();
+}
+
+/* Timed variants commit the row when the clock runs out; unlocked pegs go
+ * in empty and score nothing. */
+static inline __attribute__((always_inline))
+uint8_t turn_expired(uint8_t turn_seconds) {
+    return turn_seconds && match.game_state == GS_PLAYING &&
+           ticks_now() - turn_started >= (uint32_t)turn_seconds * TICKS_PER_SECOND;
+}
+
+/* -------------------- Variant paths -------------------- */
+#define VARIANT_FUNCS(id, colors, unique, turn_s)                              \
+    static void read_pots_##id(void)     { update_player_selections(colors); } \
+    static void check_rows_##id(void)    { check_rows(colors, unique); }       \
+    static uint8_t turn_expired_##id(void) { return turn_expired(turn_s); }    \
+    static void render_##id(void)        { render_evaluations(turn_s); }
+VARIANTS(VARIANT_FUNCS)
+
+#define VARIANT_ENTRY(id, colors, unique, turn_s) \
+    [VARIANT_##id] = { read_pots_##id, check_rows_##id, turn_expired_##id, render_##id },
+static const Variant variants[VARIANT_COUNT] = { VARIANTS(VARIANT_ENTRY) };
+
+static void select_variant(uint8_t id) {
+    variant_id = id;
+    variant = &variants[id];
+}
+
+/* -------------------- Variant menu -------------------- */
+/* Player 1's colour pot picks a variant, shown on both selection rows in
+ * the variants' menu colours with the pick lit bright. Player 2's colour pot
+ * sets the global brightness, previewed live and kept in EEPROM. Play starts
+ * once both players have pressed; the pick blinks on a row until its player
+ * has.
+ */
+_Static_assert(VARIANT_COUNT <= CODE_LEN, "one selection LED per variant");
+
+static const uint8_t menu_color[VARIANT_COUNT] = {
+    [VARIANT_CLASSIC] = COLOR_GREEN,
+    [VARIANT_WIDE]    = COLOR_WHITE,
+    [VARIANT_UNIQUE]  = COLOR_CYAN,
+    [VARIANT_TIMED]   = COLOR_RED,
+};
+
+static void choose_variant(void) {
+    uint8_t confirmed = 0, pick = VARIANT_CLASSIC, counter = 0;
+    while (confirmed != 3) {
+        uint32_t frame_start = ticks_now();
+        pick = bucket_floor(read_adc_channel(3), VARIANT_COUNT);
+        brightness = bucket_floor(read_adc_channel(5), BRIGHTNESS_STEPS);
+        if (!(PIND & (1 << PD6))) confirmed |= 1;
+        if (!(PIND & (1 << PD1))) confirmed |= 2;
+
+        for (uint8_t i = 0; i < NUM_LEDS; i++) frame[i] = COLOR_BLACK;
+        for (uint8_t p = 0; p < N_PLAYERS; p++) {
+            for (uint8_t v = 0; v < VARIANT_COUNT; v++) {
+                uint8_t code = menu_color[v];
+                if (v == pick && ((confirmed & (1 << p)) || counter >= BLINK_OFF_FRAMES)) code = BRIGHT(code);
+                frame[select_led[p][v]] = code;
+            }
+        }
+        show_frame();
+
+        wdt_reset();
+        wait_frame(frame_start);
+        counter = (counter + 1) % BLINK_FRAMES;
+    }
+    while (!(PIND & (1 << PD6)) || !(PIND & (1 << PD1))) { wdt_reset(); _delay_ms(10); }
+    select_variant(pick);
+    checkpoint_wait();                              // new_game() runs mid-session
+    eeprom_update_byte(&ee_brightness, brightness);
+}
+
+/* Both buttons once a match is over: back to the menu, then a new match
+ * with a fresh secret from the entropy pool. */
+static void new_game(void) {
+    while (!(PIND & (1 << PD6)) || !(PIND & (1 << PD1))) { wdt_reset(); _delay_ms(10); }
+    for (uint8_t i = 0; i < NUM_LEDS; i++) led_color_codes[i] = COLOR_BLACK;
+    for (uint8_t p = 0; p < N_PLAYERS; p++) consist[p].rows = CONSIST_IDLE;
+    choose_variant();
+    init_board_state();
+    checkpoint_save();
+}
+
 /* -------------------- Main -------------------- */
 int main(void) {
     DDRB |= (1 << DDB0);
@@ -314,104 +1177,167 @@ int main(void) {
 
     init_ledmap();
     init_adc();
-    init_board_state();   // now generates a new random secret each boot
+    init_timebase();
+    init_entropy();
+    sei();                // timebase, EEPROM writer and probes run from interrupts
+
+    brightness = eeprom_read_byte(&ee_brightness);
+    if (brightness >= BRIGHTNESS_STEPS) brightness = BRIGHTNESS_DEFAULT;
+
+    /* Resume the match after a watchdog/brownout reset, otherwise start fresh */
+    rng_seed_boot();
+    uint8_t have_ckpt = checkpoint_load();
+    uint8_t resume = (mcusr_mirror & RESET_RESUME) && !(mcusr_mirror & RESET_FRESH);
+    if (!(have_ckpt && resume && checkpoint_restore())) {
+        choose_variant();
+        init_board_state();   // new random secret from the entropy pool
+        checkpoint_save();    // so an early reset resumes this match, not the last one
+    }
+#if LOGIK_DEBUG
+    init_debug();
+#endif
+#if LOGIK_LATENCY
+    init_latency();
+#endif
+    wdt_enable(WDTO_250MS);
 
     while (1) {
-        update_player_selections();
+        uint32_t frame_start = ticks_now();
+        wdt_reset();
+        variant->read_pots();
         uint8_t p1_pressed = !(PIND & (1 << PD6));
         uint8_t p2_pressed = !(PIND & (1 << PD1));
+#if LOGIK_LATENCY
+        latency_note_input(p1_pressed, p2_pressed);
+#endif
 
-        if (p1_pressed) {
-            player_1_locked_leds[player_1_slot] = 1;
-            p1_sel_color[player_1_slot] = player_1_live_color;
-        }
-        if (p2_pressed) {
-            player_2_locked_leds[player_2_slot] = 1;
-            p2_sel_color[player_2_slot] = player_2_live_color;
+        if (match.game_state != GS_PLAYING) {
+            if (p1_pressed && p2_pressed) {
+                new_game();
+#if LOGIK_LATENCY
+                latency_drop();
+#endif
+            }
+        } else {
+            if (p1_pressed) {
+                player_1_locked_leds[player_1_slot] = 1;
+                p1_sel_color[player_1_slot] = player_1_live_color;
+            }
+            if (p2_pressed) {
+                player_2_locked_leds[player_2_slot] = 1;
+                p2_sel_color[player_2_slot] = player_2_live_color;
+            }
         }
 
-        if (both_players_locked_row()) {
+#if LOGIK_PROFILE
+        uint32_t prof_start = ticks_now();
+#endif
+        if (match.game_state == GS_PLAYING && both_players_locked_row()) {
             _delay_ms(50);
-            while (!(PIND & (1 << PD6)) || !(PIND & (1 << PD1))) { _delay_ms(10); }
-
-            commit_and_score_turn();
-            if (game_state == GS_PLAYING) {
-                current_turn++;
-                for (uint8_t i = 0; i < 4; i++) {
-                    player_1_locked_leds[i] = 0;
-                    player_2_locked_leds[i] = 0;
-                    p1_sel_color[i] = COLOR_BLACK;
-                    p2_sel_color[i] = COLOR_BLACK;
-                }
-            }
+            while (!(PIND & (1 << PD6)) || !(PIND & (1 << PD1))) { wdt_reset(); _delay_ms(10); }
+#if LOGIK_PROFILE
+            prof_start = ticks_now();
+#endif
+#if LOGIK_LATENCY
+            latency_drop();
+#endif
+            finish_turn();
+        } else if (variant->turn_expired()) {
+            finish_turn();
         }
 
         /* Base drawing from color codes */
-        for (uint8_t i = 0; i < NUM_LEDS; i++) led[i] = palette[led_color_codes[i]];
+        for (uint8_t i = 0; i < NUM_LEDS; i++) frame[i] = led_color_codes[i];
+
+        if (match.game_state == GS_PLAYING) {
+            variant->check_rows();
 
-        if (game_state == GS_PLAYING) {
             // Player 1 selection LEDs (display only)
             for (uint8_t s = 0; s < 4; s++) {
                 uint8_t idx = select_led[0][s];
-                led[idx] = player_1_locked_leds[s] ? palette[p1_sel_color[s]]
-                                                   : palette[COLOR_BLACK];
+                uint8_t col = p1_sel_color[s];
+                uint8_t hide = !flag_on && consistency_flagged(0, 0, s, col);
+                frame[idx] = (player_1_locked_leds[s] && !hide) ? col : COLOR_BLACK;
             }
-            led[ select_led[0][player_1_slot] ] =
-                blink_on ? palette_bright[player_1_live_color]
-                         : palette[player_1_live_color];
+            frame[ select_led[0][player_1_slot] ] =
+                (!flag_on && consistency_flagged(0, 0, player_1_slot, player_1_live_color)) ? COLOR_BLACK :
+                blink_on ? BRIGHT(player_1_live_color) : player_1_live_color;
 
             // Player 2 selection LEDs (display only)
             for (uint8_t s = 0; s < 4; s++) {
                 uint8_t idx = select_led[1][s];
-                led[idx] = player_2_locked_leds[s] ? palette[p2_sel_color[s]]
-                                                   : palette[COLOR_BLACK];
+                uint8_t col = p2_sel_color[s];
+                uint8_t hide = !flag_on && consistency_flagged(1, 1, s, col);
+                frame[idx] = (player_2_locked_leds[s] && !hide) ? col : COLOR_BLACK;
             }
-            led[ select_led[1][player_2_slot] ] =
-                blink_on ? palette_bright[player_2_live_color]
-                         : palette[player_2_live_color];
+            frame[ select_led[1][player_2_slot] ] =
+                (!flag_on && consistency_flagged(1, 1, player_2_slot, player_2_live_color)) ? COLOR_BLACK :
+                blink_on ? BRIGHT(player_2_live_color) : player_2_live_color;
 
         } else {
-            uint8_t losing_draw = (game_state == GS_DRAW) && !draw_winning;
+            uint8_t losing_draw = (match.game_state == GS_DRAW) && !match.draw_winning;
 
             if (losing_draw) {
                 /* Show the correct secret on both players' selection LEDs */
                 for (uint8_t c = 0; c < 4; c++) {
-                    uint8_t col = secret[c];
+                    uint8_t col = match.secret[c];
                     uint8_t idx0 = select_led[0][c];
                     uint8_t idx1 = select_led[1][c];
-                    led[idx0] = palette_bright[col];
-                    led[idx1] = palette_bright[col];
+                    frame[idx0] = BRIGHT(col);
+                    frame[idx1] = BRIGHT(col);
                 }
             } else {
                 /* Blink winners (or both if winning draw) */
-                uint8_t blink_p0 = (game_state == GS_P1_WIN) || (game_state == GS_DRAW && draw_winning);
-                uint8_t blink_p1 = (game_state == GS_P2_WIN) || (game_state == GS_DRAW && draw_winning);
+                uint8_t blink_p0 = (match.game_state == GS_P1_WIN) || (match.game_state == GS_DRAW && match.draw_winning);
+                uint8_t blink_p1 = (match.game_state == GS_P2_WIN) || (match.game_state == GS_DRAW && match.draw_winning);
 
                 if (blink_p0) {
                     for (uint8_t c = 0; c < 4; c++) {
                         uint8_t idx = select_led[0][c];
                         uint8_t col = p1_sel_color[c];
-                        led[idx] = blink_on ? palette_bright[col] : palette[COLOR_BLACK];
+                        frame[idx] = blink_on ? BRIGHT(col) : COLOR_BLACK;
                     }
                 }
                 if (blink_p1) {
                     for (uint8_t c = 0; c < 4; c++) {
                         uint8_t idx = select_led[1][c];
                         uint8_t col = p2_sel_color[c];
-                        led[idx] = blink_on ? palette_bright[col] : palette[COLOR_BLACK];
+                        frame[idx] = blink_on ? BRIGHT(col) : COLOR_BLACK;
                     }
                 }
             }
         }
 
         /* Render evaluations last so nothing overwrites them */
-        render_evaluations();
+        variant->render();
 
-        ws2812_setleds(led, NUM_LEDS);
+#if LOGIK_PROFILE
+        profile_record(ticks_now() - prof_start);
+#endif
+        show_frame();
+#if LOGIK_LATENCY
+        latency_note_output();
+#endif
+#if LOGIK_CAPTURE
+        capture_frame();
+#endif
+#if LOGIK_LATENCY || LOGIK_PROFILE
+        switch (dbg_getc()) {
+#if LOGIK_LATENCY
+            case 'l': latency_report(); break;
+            case 'r': latency_reset();  break;
+#endif
+#if LOGIK_PROFILE
+            case 'p': profile_report(); break;
+            case 'f': profile_feedback(); break;
+#endif
+        }
+#endif
 
-        _delay_ms(50);
+        wait_frame(frame_start);
         static uint8_t frame_counter = 0;
-        frame_counter = (frame_counter + 1) % 20;
-        blink_on = (frame_counter >= 4);
+        frame_counter = (frame_counter + 1) % BLINK_FRAMES;
+        blink_on = (frame_counter >= BLINK_OFF_FRAMES);
+        flag_on = (frame_counter / FLAG_FRAMES) & 1;
     }
 }
@@ -0,0 +1,203 @@
+/*
+ * Opening book for CODE_LEN 4, COLOR_COUNT 6, 3 plies.
+ * Generated by tools/gen_book.c -- do not edit.
+ *
+ * A tree of minimax guesses indexed by the feedback to the previous book
+ * guess. Start at book_root(colors, unique), play book_guess(), then move
+ * on with book_next(node, n_pos, n_col); BOOK_NONE means the game left the
+ * book (or the player did not play the book guess, which the book assumes).
+ *
+ * Valid only for the classic variant: BOOK_COLOR_COUNT colours with
+ * repeats allowed. book_root() returns BOOK_NONE for any other rules and
+ * book_guess() refuses BOOK_NONE, so other variants never read the table.
+ */
+
+#ifndef OPENING_BOOK_H_
+#define OPENING_BOOK_H_
+
+#include <stdint.h>
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#else
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#endif
+
+#define BOOK_CODE_LEN    4
+#define BOOK_COLOR_COUNT 6
+#define BOOK_PLIES       3
+#define BOOK_NODES       120
+#define BOOK_PACKED      2
+#define BOOK_ROOT        0
+#define BOOK_NONE        0xFFFF
+
+#if defined(CODE_LEN) && defined(COLOR_COUNT) && \
+    (CODE_LEN != BOOK_CODE_LEN || COLOR_COUNT != BOOK_COLOR_COUNT)
+#error "opening_book.h was generated for a different CODE_LEN/COLOR_COUNT"
+#endif
+
+typedef struct {
+    uint8_t  guess[BOOK_PACKED];    // two pegs per byte, high nibble first
+    uint16_t mask;                  // bit f: a child exists for feedback f
+    uint16_t first_child;
+} BookNode;
+
+/* (n_pos * (BOOK_CODE_LEN + 1) + n_col) -> feedback index, 0xFF if impossible */
+static const uint8_t book_feedback[25] PROGMEM = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 255, 9, 10,
+    11, 255, 255, 12, 255, 255, 255, 255, 13, 255, 255, 255,
+    255,
+};
+
+static const BookNode book_nodes[BOOK_NODES] PROGMEM = {
+    { {0x11, 0x22}, 0x1EFF, 1 },
+    { {0x33, 0x45}, 0x1FFF, 13 },
+    { {0x23, 0x44}, 0x1FEF, 26 },
+    { {0x23, 0x44}, 0x16EF, 38 },
+    { {0x12, 0x13}, 0x1FC0, 48 },
+    { {0x22, 0x11}, 0x0000, 0 },
+    { {0x13, 0x44}, 0x1FEF, 55 },
+    { {0x11, 0x34}, 0x1FEF, 67 },
+    { {0x12, 0x13}, 0x1EDC, 79 },
+    { {0x12, 0x34}, 0x1FFE, 88 },
+    { {0x12, 0x23}, 0x1EDC, 100 },
+    { {0x12, 0x13}, 0x1488, 109 },
+    { {0x12, 0x23}, 0x1FC0, 113 },
+    { {0x66, 0x66}, 0x0000, 0 },
+    { {0x66, 0x46}, 0x0000, 0 },
+    { {0x66, 0x34}, 0x0000, 0 },
+    { {0x46, 0x53}, 0x0000, 0 },
+    { {0x45, 0x33}, 0x0000, 0 },
+    { {0x36, 0x56}, 0x0000, 0 },
+    { {0x36, 0x36}, 0x0000, 0 },
+    { {0x34, 0x54}, 0x0000, 0 },
+    { {0x34, 0x53}, 0x0000, 0 },
+    { {0x36, 0x36}, 0x0000, 0 },
+    { {0x34, 0x43}, 0x0000, 0 },
+    { {0x34, 0x35}, 0x0000, 0 },
+    { {0x34, 0x46}, 0x0000, 0 },
+    { {0x55, 0x15}, 0x0000, 0 },
+    { {0x35, 0x16}, 0x0000, 0 },
+    { {0x32, 0x35}, 0x0000, 0 },
+    { {0x23, 0x35}, 0x0000, 0 },
+    { {0x33, 0x15}, 0x0000, 0 },
+    { {0x45, 0x14}, 0x0000, 0 },
+    { {0x32, 0x45}, 0x0000, 0 },
+    { {0x42, 0x34}, 0x0000, 0 },
+    { {0x15, 0x45}, 0x0000, 0 },
+    { {0x24, 0x25}, 0x0000, 0 },
+    { {0x24, 0x34}, 0x0000, 0 },
+    { {0x13, 0x35}, 0x0000, 0 },
+    { {0x15, 0x15}, 0x0000, 0 },
+    { {0x52, 0x15}, 0x0000, 0 },
+    { {0x32, 0x15}, 0x0000, 0 },
+    { {0x42, 0x13}, 0x0000, 0 },
+    { {0x22, 0x56}, 0x0000, 0 },
+    { {0x24, 0x15}, 0x0000, 0 },
+    { {0x24, 0x13}, 0x0000, 0 },
+    { {0x33, 0x15}, 0x0000, 0 },
+    { {0x22, 0x34}, 0x0000, 0 },
+    { {0x23, 0x14}, 0x0000, 0 },
+    { {0x11, 0x45}, 0x0000, 0 },
+    { {0x14, 0x15}, 0x0000, 0 },
+    { {0x23, 0x11}, 0x0000, 0 },
+    { {0x11, 0x45}, 0x0000, 0 },
+    { {0x41, 0x15}, 0x0000, 0 },
+    { {0x32, 0x11}, 0x0000, 0 },
+    { {0x22, 0x13}, 0x0000, 0 },
+    { {0x55, 0x25}, 0x0000, 0 },
+    { {0x35, 0x26}, 0x0000, 0 },
+    { {0x31, 0x35}, 0x0000, 0 },
+    { {0x13, 0x35}, 0x0000, 0 },
+    { {0x33, 0x25}, 0x0000, 0 },
+    { {0x45, 0x24}, 0x0000, 0 },
+    { {0x31, 0x45}, 0x0000, 0 },
+    { {0x41, 0x34}, 0x0000, 0 },
+    { {0x14, 0x15}, 0x0000, 0 },
+    { {0x14, 0x15}, 0x0000, 0 },
+    { {0x14, 0x34}, 0x0000, 0 },
+    { {0x13, 0x35}, 0x0000, 0 },
+    { {0x25, 0x25}, 0x0000, 0 },
+    { {0x23, 0x52}, 0x0000, 0 },
+    { {0x35, 0x21}, 0x0000, 0 },
+    { {0x13, 0x12}, 0x0000, 0 },
+    { {0x12, 0x56}, 0x0000, 0 },
+    { {0x15, 0x16}, 0x0000, 0 },
+    { {0x13, 0x15}, 0x0000, 0 },
+    { {0x13, 0x41}, 0x0000, 0 },
+    { {0x12, 0x35}, 0x0000, 0 },
+    { {0x13, 0x15}, 0x0000, 0 },
+    { {0x13, 0x14}, 0x0000, 0 },
+    { {0x12, 0x34}, 0x0000, 0 },
+    { {0x14, 0x15}, 0x0000, 0 },
+    { {0x11, 0x45}, 0x0000, 0 },
+    { {0x21, 0x31}, 0x0000, 0 },
+    { {0x24, 0x12}, 0x0000, 0 },
+    { {0x11, 0x14}, 0x0000, 0 },
+    { {0x11, 0x45}, 0x0000, 0 },
+    { {0x11, 0x45}, 0x0000, 0 },
+    { {0x12, 0x31}, 0x0000, 0 },
+    { {0x11, 0x14}, 0x0000, 0 },
+    { {0x25, 0x15}, 0x0000, 0 },
+    { {0x13, 0x25}, 0x0000, 0 },
+    { {0x13, 0x25}, 0x0000, 0 },
+    { {0x31, 0x42}, 0x0000, 0 },
+    { {0x13, 0x15}, 0x0000, 0 },
+    { {0x21, 0x56}, 0x0000, 0 },
+    { {0x13, 0x52}, 0x0000, 0 },
+    { {0x13, 0x23}, 0x0000, 0 },
+    { {0x15, 0x36}, 0x0000, 0 },
+    { {0x35, 0x26}, 0x0000, 0 },
+    { {0x13, 0x24}, 0x0000, 0 },
+    { {0x11, 0x34}, 0x0000, 0 },
+    { {0x41, 0x15}, 0x0000, 0 },
+    { {0x21, 0x45}, 0x0000, 0 },
+    { {0x21, 0x32}, 0x0000, 0 },
+    { {0x45, 0x12}, 0x0000, 0 },
+    { {0x21, 0x45}, 0x0000, 0 },
+    { {0x14, 0x15}, 0x0000, 0 },
+    { {0x12, 0x45}, 0x0000, 0 },
+    { {0x12, 0x32}, 0x0000, 0 },
+    { {0x11, 0x45}, 0x0000, 0 },
+    { {0x21, 0x21}, 0x0000, 0 },
+    { {0x21, 0x12}, 0x0000, 0 },
+    { {0x12, 0x21}, 0x0000, 0 },
+    { {0x12, 0x12}, 0x0000, 0 },
+    { {0x11, 0x14}, 0x0000, 0 },
+    { {0x11, 0x45}, 0x0000, 0 },
+    { {0x31, 0x22}, 0x0000, 0 },
+    { {0x11, 0x14}, 0x0000, 0 },
+    { {0x14, 0x15}, 0x0000, 0 },
+    { {0x13, 0x22}, 0x0000, 0 },
+    { {0x11, 0x23}, 0x0000, 0 },
+};
+
+/* BOOK_ROOT for a match with the book's rules, BOOK_NONE otherwise */
+static inline uint16_t book_root(uint8_t colors, uint8_t unique) {
+    return (colors == BOOK_COLOR_COUNT && !unique) ? BOOK_ROOT : BOOK_NONE;
+}
+
+/* Writes the node's guess; returns 0 and leaves out alone for BOOK_NONE */
+static inline uint8_t book_guess(uint16_t node, uint8_t out[BOOK_CODE_LEN]) {
+    if (node >= BOOK_NODES) return 0;
+    const uint8_t *g = book_nodes[node].guess;
+    for (uint8_t i = 0; i < BOOK_CODE_LEN; i++) {
+        uint8_t b = pgm_read_byte(&g[i >> 1]);
+        out[i] = (i & 1) ? (b & 0x0F) : (b >> 4);
+    }
+    return 1;
+}
+
+static inline uint16_t book_next(uint16_t node, uint8_t n_pos, uint8_t n_col) {
+    if (node == BOOK_NONE || n_pos > BOOK_CODE_LEN || n_col > BOOK_CODE_LEN) return BOOK_NONE;
+    uint8_t f = pgm_read_byte(&book_feedback[n_pos * (BOOK_CODE_LEN + 1) + n_col]);
+    uint16_t mask = pgm_read_word(&book_nodes[node].mask);
+    if (f == 0xFF || !(mask & (1u << f))) return BOOK_NONE;
+    uint16_t below = mask & ((1u << f) - 1);
+    uint16_t child = pgm_read_word(&book_nodes[node].first_child);
+    while (below) { below &= below - 1; child++; }
+    return child;
+}
+
+#endif /* OPENING_BOOK_H_ */
@@ -0,0 +1,63 @@
+/*
+ * Match protocol
+ *
+ * Shared by the Linux match server (tools/logik_server.c) and the load
+ * generator (tools/logik_loadgen.c). Every message is a type byte followed
+ * by the fixed number of bytes in proto_len(). Rows are sent in canonical
+ * column order, packed two pegs per byte, high nibble first, and a row's
+ * feedback is one byte n_pos << 3 | n_col: the same encodings the device
+ * uses for its EEPROM checkpoint (engine.h, main.c).
+ *
+ *   client  JOIN   variant key_hi key_lo
+ *   server  START  seat variant
+ *   client  ROW    packed[CODE_PACKED]
+ *   server  SCORE  turn score_self score_opp state
+ *   server  END    state draw_winning packed_secret[CODE_PACKED]
+ *   server  ERROR  code
+ *
+ * JOIN with key 0 pairs the player with anyone waiting for the same variant;
+ * any other key pairs the two players that sent it. `variant` is the index
+ * in VARIANTS() (engine.h); the server hosts the untimed ones. A client
+ * sends the next ROW once it has the previous SCORE; SCORE is sent to both
+ * players when both rows of a turn are in, and END follows the SCORE that
+ * finished the match. After END (or ERROR PROTO_ERR_LEFT) the connection may
+ * JOIN again.
+ */
+
+#ifndef PROTO_H_
+#define PROTO_H_
+
+#include "engine.h"
+
+#define MSG_JOIN    0x01
+#define MSG_START   0x02
+#define MSG_ROW     0x03
+#define MSG_SCORE   0x04
+#define MSG_END     0x05
+#define MSG_ERROR   0x06
+
+#define PROTO_ERR_MESSAGE   1       // unknown or out-of-order message
+#define PROTO_ERR_VARIANT   2       // variant not hosted
+#define PROTO_ERR_LEFT      3       // opponent disconnected
+
+#define PROTO_PORT          7310
+#define PROTO_MAX_MSG       8       // type byte + longest payload, rounded up
+
+#define SCORE_BYTE(n_pos, n_col)    ((uint8_t)((n_pos) << 3 | (n_col)))
+#define SCORE_POS(b)                (((b) >> 3) & 0x07)
+#define SCORE_COL(b)                ((b) & 0x07)
+
+/* Payload bytes after the type byte, 0 for an unknown type */
+static inline uint8_t proto_len(uint8_t type) {
+    switch (type) {
+    case MSG_JOIN:  return 3;
+    case MSG_START: return 2;
+    case MSG_ROW:   return CODE_PACKED;
+    case MSG_SCORE: return 4;
+    case MSG_END:   return 2 + CODE_PACKED;
+    case MSG_ERROR: return 1;
+    }
+    return 0;
+}
+
+#endif /* PROTO_H_ */
@@ -0,0 +1,51 @@
+/*
+ * Secret generator
+ *
+ * Shared by the firmware (main.c) and the host statistics tool
+ * (tools/rng_stats.c). A xorshift generator on four state bytes (shifts
+ * 3, 5, 2; period 2^32 - 1 over the non-zero states) needs only 8-bit
+ * shifts and XORs. Its raw output is linear and consecutive bytes are
+ * visibly correlated (the unique variant fails a chi-square test on whole
+ * secrets), so the returned byte mixes in an add and a nibble swap.
+ * rng_below() maps an output byte onto 0..n-1 with one 8x8 multiply,
+ * rejecting the 256 % n products that would make some values more likely
+ * than others. Entropy is folded in with rng_stir(), which never leaves the
+ * state at zero.
+ */
+
+#ifndef RNG_H_
+#define RNG_H_
+
+#include <stdint.h>
+
+typedef struct {
+    uint8_t x, y, z, w;
+} Rng;
+
+static inline uint8_t xorshift8(Rng *r) {
+    uint8_t t = r->x ^ (uint8_t)(r->x << 3);
+    r->x = r->y;
+    r->y = r->z;
+    r->z = r->w;
+    r->w ^= (r->w >> 2) ^ t ^ (t >> 5);
+    return (uint8_t)(r->w + r->z) ^ (uint8_t)(r->x << 4 | r->x >> 4);   // SWAP on AVR
+}
+
+static inline void rng_stir(Rng *r, uint16_t e) {
+    r->x ^= (uint8_t)e;
+    r->y ^= (uint8_t)(e >> 8);
+    if (!(r->x | r->y | r->z | r->w)) r->x = 1;
+}
+
+/* Uniform in 0..n-1, n >= 1. The modulo is only computed for the rare
+ * draws that land close enough to a bucket edge to need the check. */
+static inline uint8_t rng_below(Rng *r, uint8_t n) {
+    uint16_t m = (uint16_t)xorshift8(r) * n;
+    if ((uint8_t)m < n) {
+        uint8_t reject = (uint8_t)(0u - n) % n;     // 256 % n
+        while ((uint8_t)m < reject) m = (uint16_t)xorshift8(r) * n;
+    }
+    return (uint8_t)(m >> 8);
+}
+
+#endif /* RNG_H_ */
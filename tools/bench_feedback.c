@@ -0,0 +1,128 @@
+/*
+ * Host check and benchmark for the feedback kernel in feedback.h.
+ *
+ * Compares compute_feedback() with the original two-pass algorithm over
+ * every guess/secret pair with pegs 0..FB_MAX_COLOR (empty pegs included),
+ * then times both and reports ns and, on x86, TSC cycles per call.
+ * Exits with status 1 on the first mismatch.
+ *
+ *   bench_feedback [rounds]
+ *
+ * On the board, build with -DLOGIK_PROFILE=1 and send 'f' for AVR cycles.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+#include "../feedback.h"
+
+#define N_CODES  (1u << (3 * FB_CODE_LEN))    // codes over colours 0..7
+
+/* compute_feedback() in main.c before the kernel */
+static void reference(const uint8_t secret_[FB_CODE_LEN], const uint8_t guess[FB_CODE_LEN],
+                      uint8_t *n_pos, uint8_t *n_col) {
+    uint8_t used_s[FB_CODE_LEN] = {0}, used_g[FB_CODE_LEN] = {0};
+    uint8_t pos = 0, col = 0;
+
+    for (uint8_t i = 0; i < FB_CODE_LEN; i++) {
+        if (guess[i] && guess[i] == secret_[i]) {
+            used_s[i] = used_g[i] = 1;
+            pos++;
+        }
+    }
+    for (uint8_t i = 0; i < FB_CODE_LEN; i++) {
+        if (used_g[i] || !guess[i]) continue;
+        for (uint8_t j = 0; j < FB_CODE_LEN; j++) {
+            if (used_s[j]) continue;
+            if (guess[i] == secret_[j]) {
+                used_s[j] = 1;
+                col++;
+                break;
+            }
+        }
+    }
+    *n_pos = pos;
+    *n_col = col;
+}
+
+typedef void (*ScoreFn)(const uint8_t *, const uint8_t *, uint8_t *, uint8_t *);
+
+static uint8_t codes[N_CODES][FB_CODE_LEN];
+
+static void kernel(const uint8_t *s, const uint8_t *g, uint8_t *p, uint8_t *c) {
+    compute_feedback(s, g, p, c);
+}
+
+/* Scores every secret against a pseudo-random sequence of guesses */
+static double bench(ScoreFn fn, unsigned rounds, double *cycles, unsigned *sink) {
+    uint32_t x = 12345;
+    unsigned acc = 0;
+    unsigned long calls = 0;
+    struct timespec t0, t1;
+#if HAVE_TSC
+    uint64_t c0 = __rdtsc();
+#endif
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (unsigned r = 0; r < rounds; r++) {
+        for (uint32_t s = 0; s < N_CODES; s++) {
+            x = x * 1664525u + 1013904223u;
+            uint8_t p, c;
+            fn(codes[s], codes[x >> (32 - 3 * FB_CODE_LEN)], &p, &c);
+            acc += p * 8u + c;
+            calls++;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+#if HAVE_TSC
+    *cycles = (double)(__rdtsc() - c0) / calls;
+#else
+    *cycles = 0;
+#endif
+    *sink += acc;
+    return ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / calls;
+}
+
+int main(int argc, char **argv) {
+    unsigned rounds = argc > 1 ? (unsigned)strtoul(argv[1], NULL, 0) : 2000;
+    if (!rounds) {
+        fprintf(stderr, "usage: %s [rounds > 0]\n", argv[0]);
+        return 2;
+    }
+
+    for (uint32_t i = 0; i < N_CODES; i++)
+        for (int k = 0; k < FB_CODE_LEN; k++) codes[i][k] = (i >> (3 * k)) & FB_MAX_COLOR;
+
+    unsigned long pairs = 0;
+    for (uint32_t s = 0; s < N_CODES; s++) {
+        for (uint32_t g = 0; g < N_CODES; g++) {
+            uint8_t rp, rc, kp, kc;
+            reference(codes[s], codes[g], &rp, &rc);
+            compute_feedback(codes[s], codes[g], &kp, &kc);
+            if (rp != kp || rc != kc) {
+                fprintf(stderr, "mismatch: secret %u%u%u%u guess %u%u%u%u: reference %u/%u, kernel %u/%u\n",
+                        codes[s][0], codes[s][1], codes[s][2], codes[s][3],
+                        codes[g][0], codes[g][1], codes[g][2], codes[g][3], rp, rc, kp, kc);
+                return 1;
+            }
+            pairs++;
+        }
+    }
+    printf("%lu guess/secret pairs identical\n", pairs);
+
+    unsigned sink = 0;
+    double cyc_ref, cyc_ker;
+    double ns_ref = bench(reference, rounds, &cyc_ref, &sink);
+    double ns_ker = bench(kernel, rounds, &cyc_ker, &sink);
+    printf("reference %6.2f ns/call", ns_ref);
+    if (cyc_ref) printf(" %6.1f cycles/call", cyc_ref);
+    printf("\nkernel    %6.2f ns/call", ns_ker);
+    if (cyc_ker) printf(" %6.1f cycles/call", cyc_ker);
+    printf("\n(checksum %u)\n", sink);
+    return 0;
+}
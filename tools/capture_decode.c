@@ -0,0 +1,258 @@
+/*
+ * Host decoder for the firmware's frame capture stream (see capture.h).
+ *
+ * Rebuilds every frame from keyframes and deltas, keeping only frames whose
+ * CRC matches, then either draws it to the terminal with ANSI colours or
+ * writes it as a PPM image, and reports how many bytes each frame cost on
+ * the wire.
+ *
+ *   stty -F /dev/ttyUSB0 115200 raw
+ *   capture_decode [-t] [-o prefix] [-w width] [file]
+ *
+ *   -t         draw every frame in the terminal
+ *   -o prefix  write prefix0000.ppm, prefix0001.ppm, ...
+ *   -w width   LEDs per displayed line (default 16)
+ *
+ * Without a file the stream is read from stdin.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../capture.h"
+
+#define MAX_LEDS   255
+#define PPM_CELL   8
+
+/* Display colours for the device palettes, as RGB and scaled up so the dim
+ * levels (15, 7, 30 on the strip) are visible on a monitor. */
+static const uint8_t shade_rgb[16][3] = {
+    {  0,   0,   0}, {120,   0,   0}, {  0, 120,   0}, {  0,   0, 120},
+    { 56,  56,   0}, {  0,  56,  56}, { 56,   0,  56}, { 40,  40,  40},
+    {  0,   0,   0}, {240,   0,   0}, {  0, 240,   0}, {  0,   0, 240},
+    {240, 240,   0}, {  0, 240, 240}, {240,   0, 240}, {160, 160, 160},
+};
+
+#define MARK(b)    (0x100 | (b))  // next_byte() result for an unstuffed marker
+
+typedef struct {
+    FILE    *in;
+    uint8_t  leds[MAX_LEDS];
+    unsigned n_leds;
+    int      synced;
+    uint8_t  last_seq;
+    uint8_t  crc;               // of the frame so far
+    int      held;              // marker that cut the previous frame short, or -1
+    unsigned long bytes;        // bytes consumed since the last frame
+} Decoder;
+
+typedef struct {
+    unsigned long frames, keyframes, deltas, dropped, resyncs;
+    unsigned long bytes_total, bytes_key, bytes_delta, max_delta;
+} Stats;
+
+/* Next unstuffed byte, MARK(marker) for a frame marker, or EOF */
+static int next_byte(Decoder *d) {
+    int c = d->held;
+    if (c >= 0) {
+        d->held = -1;
+    } else {
+        c = fgetc(d->in);
+        if (c == EOF) return EOF;
+        d->bytes++;
+    }
+    if (c == CAP_KEY || c == CAP_DELTA || c == CAP_END) return MARK(c);
+    if (c == CAP_ESC) {
+        c = fgetc(d->in);
+        if (c == EOF) return EOF;
+        d->bytes++;
+        if (c == CAP_KEY || c == CAP_DELTA || c == CAP_END) return MARK(c);
+        c ^= CAP_ESC_XOR;
+    }
+    return c;
+}
+
+/* Next payload byte, added to the CRC; -1 at EOF or an unexpected marker,
+ * which is kept to start the next frame */
+static int payload_byte(Decoder *d) {
+    int c = next_byte(d);
+    if (c == EOF) return -1;
+    if (c & 0x100) {
+        d->held = c & 0xFF;
+        return -1;
+    }
+    d->crc = cap_crc8_update(d->crc, (uint8_t)c);
+    return c;
+}
+
+static int read_packed(Decoder *d, uint8_t *leds, unsigned start, unsigned count) {
+    if (start + count > MAX_LEDS) return -1;
+    for (unsigned i = 0; i < count; i += 2) {
+        int c = payload_byte(d);
+        if (c < 0) return -1;
+        leds[start + i] = (uint8_t)(c >> 4);
+        if (i + 1 < count) leds[start + i + 1] = (uint8_t)(c & 0x0F);
+    }
+    return 0;
+}
+
+/* Returns 1 for a keyframe, 2 for a delta, 0 at end of input. A frame is
+ * decoded into a copy and only kept if its CRC matches; a bad frame, or a
+ * delta after a missing one, drops the decoder out of sync until the next
+ * keyframe. */
+static int decode_frame(Decoder *d, Stats *st) {
+    for (;;) {
+        int mark = next_byte(d);
+        if (mark == EOF) return 0;
+        if (mark != MARK(CAP_KEY) && (mark != MARK(CAP_DELTA) || !d->synced)) {
+            d->bytes = 0;
+            continue;
+        }
+
+        uint8_t leds[MAX_LEDS];
+        memcpy(leds, d->leds, sizeof leds);
+        d->crc = 0;
+        int ok = 0, seq = payload_byte(d), n = (int)d->n_leds;
+
+        if (seq >= 0 && mark == MARK(CAP_KEY)) {
+            n = payload_byte(d);
+            ok = n >= 0 && read_packed(d, leds, 0, (unsigned)n) == 0;
+        } else if (seq >= 0) {
+            for (;;) {
+                int start = next_byte(d);
+                if (start == MARK(CAP_END)) { ok = 1; break; }
+                if (start < 0 || (start & 0x100)) {
+                    if (start > 0) d->held = start & 0xFF;
+                    break;
+                }
+                d->crc = cap_crc8_update(d->crc, (uint8_t)start);
+                int count = payload_byte(d);
+                if (count < 0 || start + count > n ||
+                    read_packed(d, leds, (unsigned)start, (unsigned)count) < 0) break;
+            }
+        }
+        if (ok) {
+            uint8_t crc = d->crc;
+            int sent = payload_byte(d);
+            ok = sent >= 0 && (uint8_t)sent == crc;
+        }
+        if (!ok) {
+            if (feof(d->in)) return 0;
+            if (d->synced) st->resyncs++;
+            d->synced = 0;
+            d->bytes = 0;
+            continue;
+        }
+
+        if (d->synced && (uint8_t)(seq - d->last_seq) != 1) {
+            st->dropped += (uint8_t)(seq - d->last_seq - 1);
+            if (mark == MARK(CAP_DELTA)) {          // based on a frame we missed
+                st->resyncs++;
+                d->synced = 0;
+                d->bytes = 0;
+                continue;
+            }
+        }
+        memcpy(d->leds, leds, sizeof leds);
+        d->n_leds = (unsigned)n;
+        d->synced = 1;
+        d->last_seq = (uint8_t)seq;
+        return mark == MARK(CAP_KEY) ? 1 : 2;
+    }
+}
+
+static void draw_terminal(const Decoder *d, unsigned long index, unsigned width) {
+    printf("\x1b[H\x1b[2Jframe %lu\n", index);
+    for (unsigned i = 0; i < d->n_leds; i++) {
+        const uint8_t *c = shade_rgb[d->leds[i] & 0x0F];
+        printf("\x1b[48;2;%u;%u;%um  \x1b[0m", c[0], c[1], c[2]);
+        if ((i + 1) % width == 0 || i + 1 == d->n_leds) putchar('\n');
+    }
+    fflush(stdout);
+}
+
+static int write_ppm(const Decoder *d, const char *prefix, unsigned long index,
+                     unsigned width) {
+    char path[512];
+    snprintf(path, sizeof path, "%s%04lu.ppm", prefix, index);
+    FILE *f = fopen(path, "wb");
+    if (!f) { perror(path); return -1; }
+
+    unsigned rows = (d->n_leds + width - 1) / width;
+    fprintf(f, "P6\n%u %u\n255\n", width * PPM_CELL, rows * PPM_CELL);
+    for (unsigned y = 0; y < rows * PPM_CELL; y++) {
+        for (unsigned x = 0; x < width * PPM_CELL; x++) {
+            unsigned i = (y / PPM_CELL) * width + x / PPM_CELL;
+            int border = (x % PPM_CELL == 0) || (y % PPM_CELL == 0);
+            const uint8_t *c = (i < d->n_leds && !border)
+                             ? shade_rgb[d->leds[i] & 0x0F] : shade_rgb[0];
+            fwrite(c, 1, 3, f);
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int terminal = 0;
+    const char *prefix = NULL;
+    unsigned width = 16;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "to:w:")) != -1) {
+        switch (opt) {
+        case 't': terminal = 1; break;
+        case 'o': prefix = optarg; break;
+        case 'w': width = (unsigned)atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-t] [-o prefix] [-w width] [file]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (width == 0) width = 16;
+
+    Decoder d;
+    memset(&d, 0, sizeof d);
+    d.in = stdin;
+    d.held = -1;
+    if (optind < argc) {
+        d.in = fopen(argv[optind], "rb");
+        if (!d.in) { perror(argv[optind]); return 1; }
+    }
+
+    Stats st;
+    memset(&st, 0, sizeof st);
+    int kind;
+    while ((kind = decode_frame(&d, &st)) != 0) {
+        st.bytes_total += d.bytes;
+        if (kind == 1) {
+            st.keyframes++;
+            st.bytes_key += d.bytes;
+        } else {
+            st.deltas++;
+            st.bytes_delta += d.bytes;
+            if (d.bytes > st.max_delta) st.max_delta = d.bytes;
+        }
+        d.bytes = 0;
+
+        if (terminal) draw_terminal(&d, st.frames, width);
+        if (prefix && write_ppm(&d, prefix, st.frames, width) < 0) return 1;
+        st.frames++;
+    }
+
+    fprintf(stderr, "frames %lu (key %lu, delta %lu), dropped %lu, resyncs %lu\n",
+            st.frames, st.keyframes, st.deltas, st.dropped, st.resyncs);
+    if (st.frames) {
+        fprintf(stderr, "bytes/frame %.2f (raw GRB would be %u)\n",
+                (double)st.bytes_total / st.frames, d.n_leds * 3);
+    }
+    if (st.keyframes)
+        fprintf(stderr, "bytes/keyframe %.2f\n", (double)st.bytes_key / st.keyframes);
+    if (st.deltas)
+        fprintf(stderr, "bytes/delta %.2f (max %lu)\n",
+                (double)st.bytes_delta / st.deltas, st.max_delta);
+    return 0;
+}
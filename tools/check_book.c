@@ -0,0 +1,124 @@
+/*
+ * Host check for the opening book in opening_book.h.
+ *
+ * Plays every classic secret: the book's guesses from book_root() while it
+ * has a node, then Knuth's minimax guess over the codes still consistent
+ * with the feedback. Every guess is scored with compute_feedback(). Checks
+ * that no secret leaves the book before BOOK_PLIES guesses unless solved and
+ * that every secret is solved within the turn limit, and reports the turns
+ * taken. Exits with status 1 on the first failure.
+ *
+ *   check_book [max_turns]
+ *
+ * Defaults to N_TURNS (engine.h). Rebuild after regenerating the book, as
+ * it is compiled in.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../engine.h"
+#include "../opening_book.h"
+
+#define N_CODES  (COLOR_COUNT * COLOR_COUNT * COLOR_COUNT * COLOR_COUNT)
+
+_Static_assert(CODE_LEN == 4, "N_CODES spells out four pegs");
+
+static uint8_t codes[N_CODES][CODE_LEN];
+
+static void print_code(FILE *f, const uint8_t code[CODE_LEN]) {
+    for (int i = 0; i < CODE_LEN; i++) fputc('0' + code[i], f);
+}
+
+/* Knuth's rule, as tools/gen_book.c builds the book with: the code whose
+ * worst feedback leaves the fewest of the n candidates, preferring one that
+ * could still be the secret. */
+static uint32_t minimax(const uint32_t *cand, uint32_t n) {
+    uint32_t best = cand[0], best_worst = UINT32_MAX;
+    int best_in = 0;
+    for (uint32_t g = 0; g < N_CODES; g++) {
+        uint32_t count[(CODE_LEN + 1) * (CODE_LEN + 1)] = {0}, worst = 0;
+        int in = 0;
+        for (uint32_t i = 0; i < n && worst <= best_worst; i++) {
+            uint8_t p, c;
+            compute_feedback(codes[cand[i]], codes[g], &p, &c);
+            uint32_t k = ++count[p * (CODE_LEN + 1) + c];
+            if (k > worst) worst = k;
+            if (cand[i] == g) in = 1;
+        }
+        if (worst < best_worst || (worst == best_worst && in && !best_in)) {
+            best = g;
+            best_worst = worst;
+            best_in = in;
+        }
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+    int max_turns = argc > 1 ? atoi(argv[1]) : N_TURNS;
+    if (max_turns < 1) {
+        fprintf(stderr, "usage: %s [max_turns > 0]\n", argv[0]);
+        return 2;
+    }
+
+    for (uint32_t i = 0; i < N_CODES; i++) {
+        uint32_t v = i;
+        for (int k = CODE_LEN - 1; k >= 0; k--) { codes[i][k] = (uint8_t)(v % COLOR_COUNT + 1); v /= COLOR_COUNT; }
+    }
+
+    uint32_t hist[N_CODES + 1] = {0}, total = 0;
+    int worst = 0;
+    for (uint32_t s = 0; s < N_CODES; s++) {
+        const uint8_t *secret = codes[s];
+        static uint8_t guess[N_CODES][CODE_LEN], n_pos[N_CODES], n_col[N_CODES];
+        static uint32_t cand[N_CODES];              // codes consistent with all feedback
+        uint32_t n_cand = N_CODES;
+        for (uint32_t i = 0; i < N_CODES; i++) cand[i] = i;
+        uint16_t node = book_root(COLOR_COUNT, 0);
+        int turns = 0, in_book = 0;
+
+        while (!turns || n_pos[turns - 1] != CODE_LEN) {
+            if (book_guess(node, guess[turns])) {
+                in_book++;
+            } else {
+                if (in_book < BOOK_PLIES) {
+                    fprintf(stderr, "secret ");
+                    print_code(stderr, secret);
+                    fprintf(stderr, " left the book after %d of %d plies\n", in_book, BOOK_PLIES);
+                    return 1;
+                }
+                uint32_t g = minimax(cand, n_cand);
+                for (int i = 0; i < CODE_LEN; i++) guess[turns][i] = codes[g][i];
+            }
+            compute_feedback(secret, guess[turns], &n_pos[turns], &n_col[turns]);
+            node = book_next(node, n_pos[turns], n_col[turns]);
+
+            uint32_t kept = 0;                      // the secret is always kept
+            for (uint32_t i = 0; i < n_cand; i++) {
+                uint8_t p, c;
+                compute_feedback(codes[cand[i]], guess[turns], &p, &c);
+                if (p == n_pos[turns] && c == n_col[turns]) cand[kept++] = cand[i];
+            }
+            n_cand = kept;
+            turns++;
+        }
+
+        if (turns > max_turns) {
+            fprintf(stderr, "secret ");
+            print_code(stderr, secret);
+            fprintf(stderr, " took %d turns, more than %d\n", turns, max_turns);
+            return 1;
+        }
+        hist[turns]++;
+        total += (uint32_t)turns;
+        if (turns > worst) worst = turns;
+    }
+
+    printf("%u secrets solved within %d turns (book %d plies, %u nodes)\n",
+           (unsigned)N_CODES, max_turns, BOOK_PLIES, (unsigned)BOOK_NODES);
+    for (int t = 1; t <= worst; t++) printf("  %d turns: %u\n", t, hist[t]);
+    printf("mean %.3f, worst %d\n", (double)total / N_CODES, worst);
+    return 0;
+}
@@ -0,0 +1,251 @@
+/*
+ * Opening book generator.
+ *
+ * Solves the first plies of Logik offline with Knuth's minimax rule (pick
+ * the guess whose worst feedback leaves the fewest candidate secrets,
+ * preferring guesses that could still be the secret) and writes the
+ * resulting feedback-indexed decision tree as a PROGMEM table with a small
+ * lookup API.
+ *
+ *   gen_book [code_len] [color_count] [plies] > opening_book.h
+ *
+ * Defaults match the classic variant (engine.h): 4 pegs, 6 colours,
+ * repeats allowed, 3 plies. The book assumes any code can be the secret, so
+ * it only serves variants with repeats allowed and exactly that many
+ * colours; book_root() turns every other one away.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_LEN    6
+#define MAX_COLORS 15                 // codes are packed as nibbles
+#define MAX_FB     ((MAX_LEN + 1) * (MAX_LEN + 1))
+
+typedef struct {
+    uint16_t guess;                   // index into codes[]
+    uint16_t mask;                    // bit f: child for dense feedback f
+    uint16_t first_child;
+    uint16_t *set;                    // candidate secrets at this node
+    uint32_t n_set;
+} Node;
+
+static int code_len = 4, colors = 6, plies = 3;
+static uint32_t n_codes;
+static uint8_t (*codes)[MAX_LEN];
+
+static uint8_t fb_dense[MAX_FB];      // (n_pos * (len + 1) + n_col) -> dense index
+static uint8_t n_fb;
+static uint8_t fb_win;                // dense index of an all-exact answer
+
+static Node *nodes;
+static uint32_t n_nodes, cap_nodes;
+
+/* Same rules as compute_feedback() in feedback.h */
+static uint8_t score(const uint8_t *secret, const uint8_t *guess) {
+    uint8_t cs[MAX_COLORS + 1] = {0}, cg[MAX_COLORS + 1] = {0};
+    uint8_t pos = 0, col = 0;
+    for (int i = 0; i < code_len; i++) {
+        if (guess[i] && guess[i] == secret[i]) pos++;
+        else { cs[secret[i]]++; cg[guess[i]]++; }
+    }
+    for (int c = 1; c <= colors; c++) col += cs[c] < cg[c] ? cs[c] : cg[c];
+    return fb_dense[pos * (code_len + 1) + col];
+}
+
+static uint16_t best_guess(const uint16_t *set, uint32_t n_set) {
+    uint32_t best_worst = UINT32_MAX;
+    int best_in_set = 0;
+    uint16_t best = 0;
+    uint32_t count[MAX_FB];
+
+    char *in_set = calloc(n_codes, 1);
+    for (uint32_t i = 0; i < n_set; i++) in_set[set[i]] = 1;
+
+    for (uint32_t g = 0; g < n_codes; g++) {
+        memset(count, 0, sizeof count);
+        uint32_t worst = 0;
+        for (uint32_t i = 0; i < n_set && worst <= best_worst; i++) {
+            uint32_t c = ++count[score(codes[set[i]], codes[g])];
+            if (c > worst) worst = c;
+        }
+        if (worst < best_worst || (worst == best_worst && in_set[g] && !best_in_set)) {
+            best_worst = worst;
+            best_in_set = in_set[g];
+            best = (uint16_t)g;
+        }
+    }
+    free(in_set);
+    return best;
+}
+
+static uint32_t add_node(uint16_t *set, uint32_t n_set) {
+    if (n_nodes == cap_nodes) {
+        cap_nodes = cap_nodes ? cap_nodes * 2 : 64;
+        nodes = realloc(nodes, cap_nodes * sizeof *nodes);
+    }
+    Node *n = &nodes[n_nodes];
+    memset(n, 0, sizeof *n);
+    n->set = set;
+    n->n_set = n_set;
+    n->guess = n_set == 1 ? set[0] : best_guess(set, n_set);
+    return n_nodes++;
+}
+
+/* Nodes are laid out breadth-first so every node's children are contiguous */
+static void build(void) {
+    uint16_t *all = malloc(n_codes * sizeof *all);
+    for (uint32_t i = 0; i < n_codes; i++) all[i] = (uint16_t)i;
+    add_node(all, n_codes);
+
+    uint32_t level_start = 0, level_end = 1;
+    for (int ply = 1; ply < plies; ply++) {
+        for (uint32_t i = level_start; i < level_end; i++) {
+            nodes[i].first_child = (uint16_t)n_nodes;
+            for (uint8_t f = 0; f < n_fb; f++) {
+                if (f == fb_win) continue;
+                Node *n = &nodes[i];
+                uint16_t *sub = malloc(n->n_set * sizeof *sub);
+                uint32_t n_sub = 0;
+                for (uint32_t k = 0; k < n->n_set; k++) {
+                    if (score(codes[n->set[k]], codes[n->guess]) == f) sub[n_sub++] = n->set[k];
+                }
+                if (!n_sub) { free(sub); continue; }
+                nodes[i].mask |= (uint16_t)(1u << f);
+                add_node(sub, n_sub);
+            }
+        }
+        level_start = level_end;
+        level_end = n_nodes;
+    }
+}
+
+static void emit(void) {
+    int packed = (code_len + 1) / 2;
+
+    printf("/*\n"
+           " * Opening book for CODE_LEN %d, COLOR_COUNT %d, %d plies.\n"
+           " * Generated by tools/gen_book.c -- do not edit.\n"
+           " *\n"
+           " * A tree of minimax guesses indexed by the feedback to the previous book\n"
+           " * guess. Start at book_root(colors, unique), play book_guess(), then move\n"
+           " * on with book_next(node, n_pos, n_col); BOOK_NONE means the game left the\n"
+           " * book (or the player did not play the book guess, which the book assumes).\n"
+           " *\n"
+           " * Valid only for the classic variant: BOOK_COLOR_COUNT colours with\n"
+           " * repeats allowed. book_root() returns BOOK_NONE for any other rules and\n"
+           " * book_guess() refuses BOOK_NONE, so other variants never read the table.\n"
+           " */\n\n", code_len, colors, plies);
+    printf("#ifndef OPENING_BOOK_H_\n#define OPENING_BOOK_H_\n\n");
+    printf("#include <stdint.h>\n"
+           "#ifdef __AVR__\n#include <avr/pgmspace.h>\n#else\n"
+           "#define PROGMEM\n"
+           "#define pgm_read_byte(p) (*(const uint8_t *)(p))\n"
+           "#define pgm_read_word(p) (*(const uint16_t *)(p))\n"
+           "#endif\n\n");
+    printf("#define BOOK_CODE_LEN    %d\n", code_len);
+    printf("#define BOOK_COLOR_COUNT %d\n", colors);
+    printf("#define BOOK_PLIES       %d\n", plies);
+    printf("#define BOOK_NODES       %u\n", n_nodes);
+    printf("#define BOOK_PACKED      %d\n", packed);
+    printf("#define BOOK_ROOT        0\n");
+    printf("#define BOOK_NONE        0xFFFF\n\n");
+    printf("#if defined(CODE_LEN) && defined(COLOR_COUNT) && \\\n"
+           "    (CODE_LEN != BOOK_CODE_LEN || COLOR_COUNT != BOOK_COLOR_COUNT)\n"
+           "#error \"opening_book.h was generated for a different CODE_LEN/COLOR_COUNT\"\n"
+           "#endif\n\n");
+
+    printf("typedef struct {\n"
+           "    uint8_t  guess[BOOK_PACKED];    // two pegs per byte, high nibble first\n"
+           "    uint16_t mask;                  // bit f: a child exists for feedback f\n"
+           "    uint16_t first_child;\n"
+           "} BookNode;\n\n");
+
+    printf("/* (n_pos * (BOOK_CODE_LEN + 1) + n_col) -> feedback index, 0xFF if impossible */\n");
+    printf("static const uint8_t book_feedback[%d] PROGMEM = {", (code_len + 1) * (code_len + 1));
+    for (int i = 0; i < (code_len + 1) * (code_len + 1); i++)
+        printf("%s%u,", i % 12 ? " " : "\n    ", fb_dense[i]);
+    printf("\n};\n\n");
+
+    printf("static const BookNode book_nodes[BOOK_NODES] PROGMEM = {\n");
+    for (uint32_t i = 0; i < n_nodes; i++) {
+        const uint8_t *c = codes[nodes[i].guess];
+        printf("    { {");
+        for (int b = 0; b < packed; b++) {
+            uint8_t hi = c[2 * b], lo = (2 * b + 1 < code_len) ? c[2 * b + 1] : 0;
+            printf("%s0x%X%X", b ? ", " : "", hi, lo);
+        }
+        printf("}, 0x%04X, %u },\n", nodes[i].mask, nodes[i].mask ? nodes[i].first_child : 0);
+    }
+    printf("};\n\n");
+
+    printf("/* BOOK_ROOT for a match with the book's rules, BOOK_NONE otherwise */\n"
+           "static inline uint16_t book_root(uint8_t colors, uint8_t unique) {\n"
+           "    return (colors == BOOK_COLOR_COUNT && !unique) ? BOOK_ROOT : BOOK_NONE;\n"
+           "}\n\n");
+    printf("/* Writes the node's guess; returns 0 and leaves out alone for BOOK_NONE */\n"
+           "static inline uint8_t book_guess(uint16_t node, uint8_t out[BOOK_CODE_LEN]) {\n"
+           "    if (node >= BOOK_NODES) return 0;\n"
+           "    const uint8_t *g = book_nodes[node].guess;\n"
+           "    for (uint8_t i = 0; i < BOOK_CODE_LEN; i++) {\n"
+           "        uint8_t b = pgm_read_byte(&g[i >> 1]);\n"
+           "        out[i] = (i & 1) ? (b & 0x0F) : (b >> 4);\n"
+           "    }\n"
+           "    return 1;\n"
+           "}\n\n");
+    printf("static inline uint16_t book_next(uint16_t node, uint8_t n_pos, uint8_t n_col) {\n"
+           "    if (node == BOOK_NONE || n_pos > BOOK_CODE_LEN || n_col > BOOK_CODE_LEN) return BOOK_NONE;\n"
+           "    uint8_t f = pgm_read_byte(&book_feedback[n_pos * (BOOK_CODE_LEN + 1) + n_col]);\n"
+           "    uint16_t mask = pgm_read_word(&book_nodes[node].mask);\n"
+           "    if (f == 0xFF || !(mask & (1u << f))) return BOOK_NONE;\n"
+           "    uint16_t below = mask & ((1u << f) - 1);\n"
+           "    uint16_t child = pgm_read_word(&book_nodes[node].first_child);\n"
+           "    while (below) { below &= below - 1; child++; }\n"
+           "    return child;\n"
+           "}\n\n");
+    printf("#endif /* OPENING_BOOK_H_ */\n");
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) code_len = atoi(argv[1]);
+    if (argc > 2) colors = atoi(argv[2]);
+    if (argc > 3) plies = atoi(argv[3]);
+    if (code_len < 1 || code_len > MAX_LEN || colors < 1 || colors > MAX_COLORS || plies < 1) {
+        fprintf(stderr, "usage: %s [code_len 1..%d] [color_count 1..%d] [plies >= 1]\n",
+                argv[0], MAX_LEN, MAX_COLORS);
+        return 2;
+    }
+
+    n_codes = 1;
+    for (int i = 0; i < code_len; i++) n_codes *= (uint32_t)colors;
+    if (n_codes > 0xFFFF) {
+        fprintf(stderr, "%u codes do not fit a 16-bit index\n", n_codes);
+        return 2;
+    }
+    codes = malloc(n_codes * sizeof *codes);
+    for (uint32_t i = 0; i < n_codes; i++) {
+        uint32_t v = i;
+        for (int k = code_len - 1; k >= 0; k--) { codes[i][k] = (uint8_t)(v % colors + 1); v /= colors; }
+    }
+
+    memset(fb_dense, 0xFF, sizeof fb_dense);
+    for (int p = 0; p <= code_len; p++) {
+        for (int c = 0; p + c <= code_len; c++) {
+            if (p == code_len - 1 && c == 1) continue;
+            if (p == code_len) fb_win = n_fb;
+            fb_dense[p * (code_len + 1) + c] = n_fb++;
+        }
+    }
+    if (n_fb > 16) {
+        fprintf(stderr, "%u feedback values do not fit the 16-bit child mask\n", n_fb);
+        return 2;
+    }
+
+    build();
+    emit();
+    fprintf(stderr, "%u nodes, %zu bytes of flash\n", n_nodes,
+            n_nodes * (size_t)((code_len + 1) / 2 + 4) + (size_t)(code_len + 1) * (code_len + 1));
+    return 0;
+}
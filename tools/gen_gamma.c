@@ -0,0 +1,46 @@
+/*
+ * Gamma/brightness LUT generator.
+ *
+ * Palettes in main.c hold perceptual levels 0..GAMMA_LEVELS-1. For every
+ * global brightness step this writes the matching strip values as 8.8 fixed
+ * point: out = peak * (level / (GAMMA_LEVELS - 1)) ^ GAMMA. The fraction is
+ * what ws2812_setleds_lut() dithers over time.
+ *
+ *   gen_gamma > gamma_lut.h
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#define GAMMA               2.2
+#define GAMMA_LEVELS        32
+#define BRIGHTNESS_STEPS    8
+#define BRIGHTNESS_DEFAULT  4      // peak 32, the strip values the game started with
+#define PEAK_DEFAULT        32.0
+#define PEAK_RATIO          1.5    // per brightness step
+
+int main(void) {
+    printf("/*\n"
+           " * Gamma %.1f LUTs for %d perceptual levels at %d brightness steps, as\n"
+           " * 8.8 fixed-point strip values for ws2812_setleds_lut().\n"
+           " * Generated by tools/gen_gamma.c -- do not edit.\n"
+           " */\n\n", GAMMA, GAMMA_LEVELS, BRIGHTNESS_STEPS);
+    printf("#ifndef GAMMA_LUT_H_\n#define GAMMA_LUT_H_\n\n");
+    printf("#include <avr/pgmspace.h>\n\n");
+    printf("#define GAMMA_LEVELS        %d\n", GAMMA_LEVELS);
+    printf("#define BRIGHTNESS_STEPS    %d\n", BRIGHTNESS_STEPS);
+    printf("#define BRIGHTNESS_DEFAULT  %d\n\n", BRIGHTNESS_DEFAULT);
+    printf("static const uint16_t gamma_lut[BRIGHTNESS_STEPS][GAMMA_LEVELS] PROGMEM = {\n");
+    for (int b = 0; b < BRIGHTNESS_STEPS; b++) {
+        double peak = PEAK_DEFAULT * pow(PEAK_RATIO, b - BRIGHTNESS_DEFAULT);
+        printf("    {   // peak %.1f\n       ", peak);
+        for (int l = 0; l < GAMMA_LEVELS; l++) {
+            double v = peak * pow((double)l / (GAMMA_LEVELS - 1), GAMMA) * 256.0 + 0.5;
+            if (v > 254.0 * 256.0) v = 254.0 * 256.0;   // rounding up must not wrap
+            printf(" 0x%04X,%s", (unsigned)v, (l % 8 == 7 && l + 1 < GAMMA_LEVELS) ? "\n       " : "");
+        }
+        printf("\n    },\n");
+    }
+    printf("};\n\n#endif /* GAMMA_LUT_H_ */\n");
+    return 0;
+}
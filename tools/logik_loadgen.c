@@ -0,0 +1,351 @@
+/*
+ * Load generator for tools/logik_server.c.
+ *
+ * Plays `matches` concurrent matches (two connections per match slot) with
+ * random rows, joining the next match on the same connections as soon as
+ * END arrives.
+ *
+ * By default a slot's two connections play each other with key = slot + 1,
+ * and commit latency is measured per turn from sending the second row to
+ * receiving the second SCORE. With -r every connection joins with key 0 and
+ * the server's lobby pairs them, usually across slots and threads. Each
+ * connection then plays on its own, and latency is measured per player from
+ * sending its row to receiving its SCORE.
+ *
+ *   logik_loadgen [-h host] [-p port] [-m matches] [-d seconds] [-t threads] [-v variant] [-r]
+ *
+ *   -m matches   concurrent match slots (default 1000, at most 65535)
+ *   -d seconds   measuring time after every slot has started (default 10)
+ *   -t threads   client threads, each with its own epoll (default 4)
+ *   -v variant   index in VARIANTS() (engine.h) to join (default 0, classic)
+ *   -r           random opponents (key 0)
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../proto.h"
+
+#define MAX_THREADS  64
+#define IN_CAP       64
+#define EVENTS       256
+#define LAT_BUCKETS  1000000        // 1 µs buckets up to 1 s, the last one is "or more"
+
+typedef struct Slot Slot;
+
+typedef struct {
+    int fd;
+    Slot *slot;
+    uint64_t t_sent;            // ns, -r: this player's row sent
+    uint8_t in[IN_CAP];
+    uint8_t in_len;
+} Player;
+
+struct Slot {
+    Player p[N_PLAYERS];
+    uint16_t key;
+    uint8_t sent;               // rows sent this turn
+    uint8_t scored;             // SCOREs received this turn
+    uint8_t ended;              // ENDs received this match
+    uint64_t t_sent;            // ns, second row of the turn sent
+};
+
+typedef struct {
+    pthread_t thread;
+    int ep;
+    Slot *slots;
+    size_t n_slots;
+    Rng rng;
+
+    uint64_t matches, commits;  // counted while measuring, per player with -r
+    uint64_t max_ns;
+    uint32_t *lat;              // LAT_BUCKETS histogram, µs
+} Worker;
+
+static struct sockaddr_storage server;
+static socklen_t server_len;
+static uint8_t variant, colors;
+static int random_opponents;
+static atomic_int measuring, stopping;     // set by main, polled by the workers
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void die(const char *what) {
+    perror(what);
+    exit(1);
+}
+
+/* Messages are a few bytes, so a full socket buffer is treated as fatal */
+static void send_all(int fd, const uint8_t *msg, size_t len) {
+    if (send(fd, msg, len, MSG_NOSIGNAL) != (ssize_t)len) die("send");
+}
+
+static void send_join(Slot *s, Player *pl) {
+    uint16_t key = random_opponents ? 0 : s->key;
+    uint8_t msg[4] = { MSG_JOIN, variant, (uint8_t)(key >> 8), (uint8_t)key };
+    send_all(pl->fd, msg, sizeof msg);
+}
+
+static void send_row(Worker *w, Player *pl) {
+    uint8_t row[CODE_LEN], msg[1 + CODE_PACKED] = { MSG_ROW };
+    for (uint8_t i = 0; i < CODE_LEN; i++) row[i] = rng_below(&w->rng, colors) + 1;
+    pack_code(msg + 1, row);
+    pl->t_sent = now_ns();
+    send_all(pl->fd, msg, sizeof msg);
+}
+
+static void send_rows(Worker *w, Slot *s) {
+    for (uint8_t p = 0; p < N_PLAYERS; p++) send_row(w, &s->p[p]);
+    s->t_sent = s->p[N_PLAYERS - 1].t_sent;
+    s->sent = N_PLAYERS;
+    s->scored = 0;
+}
+
+static void record(Worker *w, uint64_t t_sent) {
+    uint64_t ns = now_ns() - t_sent;
+    uint64_t us = ns / 1000;
+    w->lat[us < LAT_BUCKETS ? us : LAT_BUCKETS - 1]++;
+    if (ns > w->max_ns) w->max_ns = ns;
+    w->commits++;
+}
+
+/* -r: the opponent is some other connection, so each player runs alone */
+static void on_message_alone(Worker *w, Player *pl, const uint8_t *msg) {
+    switch (msg[0]) {
+    case MSG_START:
+        send_row(w, pl);
+        break;
+    case MSG_SCORE:
+        if (atomic_load(&measuring)) record(w, pl->t_sent);
+        if (msg[4] == GS_PLAYING) send_row(w, pl);
+        break;
+    case MSG_END:
+        if (atomic_load(&measuring)) w->matches++;
+        send_join(pl->slot, pl);
+        break;
+    default:
+        fprintf(stderr, "server sent %02x %02x\n", msg[0], msg[1]);
+        exit(1);
+    }
+}
+
+static void on_message(Worker *w, Player *pl, const uint8_t *msg) {
+    Slot *s = pl->slot;
+    if (random_opponents) {
+        on_message_alone(w, pl, msg);
+        return;
+    }
+    switch (msg[0]) {
+    case MSG_START:
+        /* Both seats start before either can score, so START from the
+         * second player begins the first turn */
+        if (++s->sent == N_PLAYERS) send_rows(w, s);
+        break;
+    case MSG_SCORE:
+        if (++s->scored < N_PLAYERS) break;
+        if (atomic_load(&measuring)) record(w, s->t_sent);
+        if (msg[4] == GS_PLAYING) send_rows(w, s);
+        break;
+    case MSG_END:
+        if (++s->ended < N_PLAYERS) break;
+        if (atomic_load(&measuring)) w->matches++;
+        s->sent = s->scored = s->ended = 0;
+        for (uint8_t p = 0; p < N_PLAYERS; p++) send_join(s, &s->p[p]);
+        break;
+    default:
+        fprintf(stderr, "slot %u: server sent %02x %02x\n", s->key, msg[0], msg[1]);
+        exit(1);
+    }
+}
+
+static void on_readable(Worker *w, Player *pl) {
+    for (;;) {
+        ssize_t n = recv(pl->fd, pl->in + pl->in_len, IN_CAP - pl->in_len, 0);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            if (atomic_load(&stopping)) return;
+            fprintf(stderr, "slot %u: server closed the connection\n", pl->slot->key);
+            exit(1);
+        }
+        pl->in_len += (uint8_t)n;
+
+        size_t used = 0;
+        while (used < pl->in_len) {
+            uint8_t len = proto_len(pl->in[used]);
+            if (pl->in_len - used < 1u + len) break;
+            on_message(w, pl, pl->in + used);
+            used += 1u + len;
+        }
+        memmove(pl->in, pl->in + used, pl->in_len - used);
+        pl->in_len -= (uint8_t)used;
+    }
+}
+
+/* Connects blocking, then reads without blocking */
+static void connect_player(Worker *w, Player *pl) {
+    int fd = socket(server.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) die("socket");
+    if (connect(fd, (struct sockaddr *)&server, server_len) < 0) die("connect");
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = pl };
+    if (epoll_ctl(w->ep, EPOLL_CTL_ADD, fd, &ev) < 0) die("epoll_ctl");
+    pl->fd = fd;
+}
+
+static void *worker_main(void *arg) {
+    Worker *w = arg;
+
+    for (size_t i = 0; i < w->n_slots; i++) {
+        Slot *s = &w->slots[i];
+        for (uint8_t p = 0; p < N_PLAYERS; p++) {
+            s->p[p].slot = s;
+            connect_player(w, &s->p[p]);
+        }
+    }
+    for (size_t i = 0; i < w->n_slots; i++) {
+        for (uint8_t p = 0; p < N_PLAYERS; p++) send_join(&w->slots[i], &w->slots[i].p[p]);
+    }
+
+    struct epoll_event ev[EVENTS];
+    while (!atomic_load(&stopping)) {
+        int n = epoll_wait(w->ep, ev, EVENTS, 100);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) die("epoll_wait");
+        for (int i = 0; i < n; i++) on_readable(w, ev[i].data.ptr);
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    const char *host = "localhost";
+    char port[8];
+    snprintf(port, sizeof port, "%d", PROTO_PORT);
+    unsigned long n_matches = 1000, seconds = 10;
+    int n_threads = 4;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "h:p:m:d:t:v:r")) != -1) {
+        switch (opt) {
+        case 'h': host = optarg; break;
+        case 'p': snprintf(port, sizeof port, "%s", optarg); break;
+        case 'm': n_matches = strtoul(optarg, NULL, 0); break;
+        case 'd': seconds = strtoul(optarg, NULL, 0); break;
+        case 't': n_threads = atoi(optarg); break;
+        case 'v': variant = (uint8_t)atoi(optarg); break;
+        case 'r': random_opponents = 1; break;
+        default:
+            fprintf(stderr, "usage: %s [-h host] [-p port] [-m matches] [-d seconds] [-t threads] [-v variant] [-r]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+    if (!n_matches || n_matches > 65535 || !seconds) {
+        fprintf(stderr, "need 1..65535 matches and a non-zero duration\n");
+        return 2;
+    }
+    if (variant >= VARIANT_COUNT) {
+        fprintf(stderr, "variant must be below %d\n", VARIANT_COUNT);
+        return 2;
+    }
+    colors = variant_rules[variant].colors;
+    if (n_threads < 1) n_threads = 1;
+    if (n_threads > MAX_THREADS) n_threads = MAX_THREADS;
+    if ((unsigned long)n_threads > n_matches) n_threads = (int)n_matches;
+
+    struct addrinfo hints = { .ai_socktype = SOCK_STREAM }, *ai;
+    int err = getaddrinfo(host, port, &hints, &ai);
+    if (err) {
+        fprintf(stderr, "%s: %s\n", host, gai_strerror(err));
+        return 1;
+    }
+    memcpy(&server, ai->ai_addr, ai->ai_addrlen);
+    server_len = ai->ai_addrlen;
+    freeaddrinfo(ai);
+
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    Slot *slots = calloc(n_matches, sizeof *slots);
+    Worker workers[MAX_THREADS] = {0};
+    if (!slots) die("calloc");
+    for (unsigned long i = 0; i < n_matches; i++) slots[i].key = (uint16_t)(i + 1);
+
+    size_t start = 0;
+    for (int t = 0; t < n_threads; t++) {
+        Worker *w = &workers[t];
+        size_t n = n_matches / n_threads + ((unsigned long)t < n_matches % n_threads);
+        w->slots = slots + start;
+        w->n_slots = n;
+        start += n;
+        w->ep = epoll_create1(EPOLL_CLOEXEC);
+        w->lat = calloc(LAT_BUCKETS, sizeof *w->lat);
+        if (w->ep < 0 || !w->lat) die("worker");
+        w->rng = (Rng){ (uint8_t)(t + 1), 0x5A, (uint8_t)(time(NULL)), 0xC3 };
+        pthread_create(&w->thread, NULL, worker_main, w);
+    }
+
+    sleep(1);                                       // let every slot connect and join
+    uint64_t t0 = now_ns();
+    atomic_store(&measuring, 1);
+    sleep((unsigned)seconds);
+    atomic_store(&measuring, 0);
+    double elapsed = (now_ns() - t0) / 1e9;
+    atomic_store(&stopping, 1);
+    for (int t = 0; t < n_threads; t++) pthread_join(workers[t].thread, NULL);
+
+    uint64_t matches = 0, commits = 0, max_ns = 0;
+    uint64_t *lat = calloc(LAT_BUCKETS, sizeof *lat);
+    if (!lat) die("calloc");
+    for (int t = 0; t < n_threads; t++) {
+        matches += workers[t].matches;
+        commits += workers[t].commits;
+        if (workers[t].max_ns > max_ns) max_ns = workers[t].max_ns;
+        for (size_t b = 0; b < LAT_BUCKETS; b++) lat[b] += workers[t].lat[b];
+    }
+
+    uint64_t p50 = 0, p99 = 0, seen = 0, samples = commits;
+    for (size_t b = 0; b < LAT_BUCKETS && samples; b++) {
+        seen += lat[b];
+        if (!p50 && seen * 100 >= samples * 50) p50 = b + 1;
+        if (seen * 100 >= samples * 99) { p99 = b + 1; break; }
+    }
+    if (random_opponents) {                         // both players counted them
+        matches /= N_PLAYERS;
+        commits /= N_PLAYERS;
+    }
+
+    printf("%lu concurrent matches (%s opponents), %d threads, %.1f s\n", n_matches,
+           random_opponents ? "random" : "keyed", n_threads, elapsed);
+    printf("matches/s %.0f\n", matches / elapsed);
+    printf("commits/s %.0f\n", commits / elapsed);
+    printf("commit latency p50 <%llu us, p99 <%llu us, max %.0f us\n",
+           (unsigned long long)p50, (unsigned long long)p99, max_ns / 1e3);
+    return 0;
+}
@@ -0,0 +1,646 @@
+/*
+ * Linux match server for the device rules (engine.h), speaking the match
+ * protocol in proto.h.
+ *
+ * The main thread accepts connections and deals them out round-robin to a
+ * pool of worker shards. Each shard owns an epoll loop, its connections and
+ * every match between them, so game state is never shared between threads.
+ * A keyed JOIN is moved to the shard that owns its key so both players meet
+ * there. A key-0 JOIN goes to the lobby on the main thread, which pairs it
+ * with a waiting player and deals the new match to the next shard. Handoff
+ * queues are the only locks.
+ *
+ *   logik_server [-p port] [-t threads] [-q]
+ *
+ *   -p port     TCP port (default PROTO_PORT)
+ *   -t threads  worker shards (default: online CPUs)
+ *   -q          no statistics line every 5 s
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/random.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../proto.h"
+
+#define MAX_SHARDS   64
+#define KEY_BUCKETS  256
+#define IN_CAP       64
+#define OUT_CAP      256
+#define EVENTS       256
+#define NO_VARIANT   0xFF
+
+/* The server keeps no turn clock, so it hosts the untimed variants */
+static inline int hosted(uint8_t variant) {
+    return variant < VARIANT_COUNT && !variant_rules[variant].turn_seconds;
+}
+
+typedef struct Game Game;
+
+typedef struct Conn {
+    int fd;
+    uint8_t in[IN_CAP];
+    uint8_t in_len;
+    uint8_t out[OUT_CAP];
+    uint16_t out_len;
+    uint8_t want_out;           // EPOLLOUT armed
+    uint8_t closing;            // closed once its own event is handled
+
+    uint8_t variant;            // while waiting, NO_VARIANT otherwise
+    uint16_t key;
+    struct Conn *wait_next;
+
+    Game *game;
+    uint8_t seat;
+} Conn;
+
+struct Game {
+    Match m;
+    Conn *seat[N_PLAYERS];
+    uint8_t rows[N_PLAYERS][CODE_LEN];
+    uint8_t have;               // bit p: seat p sent this turn's row
+    Game *free_next;
+};
+
+enum { PAIR_NONE, PAIR_FIRST, PAIR_SECOND };
+
+typedef struct {
+    int fd;
+    uint8_t variant;            // NO_VARIANT: fresh connection, no JOIN yet
+    uint16_t key;
+    uint8_t pair;               // PAIR_SECOND starts a match with the PAIR_FIRST before it
+    uint8_t in[IN_CAP];         // bytes received after the JOIN
+    uint8_t in_len;
+    uint8_t out[OUT_CAP];       // replies not sent yet
+    uint16_t out_len;
+} Handoff;
+
+typedef struct {
+    int efd;                    // signalled after every push
+    pthread_mutex_t lock;       // guards the queue
+    Handoff *q;
+    size_t q_len, q_cap;
+} Inbox;
+
+typedef struct {
+    int id;
+    int ep;
+    pthread_t thread;
+    Inbox in;
+
+    Conn *keyed[KEY_BUCKETS];   // waiting for the player with the same key
+    Game *free_games;
+    Rng rng;
+
+    uint64_t matches, commits;  // read by the statistics line
+    uint32_t active;
+} Shard;
+
+/* Key-0 matchmaking, owned by the main thread */
+typedef struct {
+    Inbox in;
+    Handoff *waiting[VARIANT_COUNT];    // at most one player waits per variant
+    int next_shard;                     // round-robin placement of new matches
+} Lobby;
+
+static Shard shards[MAX_SHARDS];
+static int n_shards;
+static Lobby lobby;
+
+/* -------------------- Output -------------------- */
+/* A connection that fails while another one is being handled is shut down
+ * so epoll reports it, and closed from its own event. */
+static void fail(Conn *c) {
+    c->closing = 1;
+    shutdown(c->fd, SHUT_RDWR);
+}
+
+static void set_events(Shard *sh, Conn *c, int want_out) {
+    if (c->want_out == want_out) return;
+    struct epoll_event ev = { .events = EPOLLIN | (want_out ? EPOLLOUT : 0), .data.ptr = c };
+    epoll_ctl(sh->ep, EPOLL_CTL_MOD, c->fd, &ev);
+    c->want_out = (uint8_t)want_out;
+}
+
+static void flush_out(Shard *sh, Conn *c) {
+    while (c->out_len) {
+        ssize_t n = send(c->fd, c->out, c->out_len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            fail(c);
+            return;
+        }
+        memmove(c->out, c->out + n, c->out_len - (size_t)n);
+        c->out_len -= (uint16_t)n;
+    }
+    set_events(sh, c, c->out_len != 0);
+}
+
+static void send_msg(Shard *sh, Conn *c, const uint8_t *msg) {
+    uint8_t len = 1 + proto_len(msg[0]);
+    if (c->out_len + len > OUT_CAP) { fail(c); return; }    // peer is not reading
+    memcpy(c->out + c->out_len, msg, len);
+    c->out_len += len;
+    flush_out(sh, c);
+}
+
+static void send_error(Shard *sh, Conn *c, uint8_t code) {
+    uint8_t msg[2] = { MSG_ERROR, code };
+    send_msg(sh, c, msg);
+}
+
+/* -------------------- Handoff -------------------- */
+static void init_inbox(Inbox *in) {
+    in->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (in->efd < 0) { perror("eventfd"); exit(1); }
+    pthread_mutex_init(&in->lock, NULL);
+}
+
+/* Queues n handoffs together, so a pair is never split */
+static void push_handoffs(Inbox *to, const Handoff *h, size_t n) {
+    pthread_mutex_lock(&to->lock);
+    while (to->q_len + n > to->q_cap) {
+        to->q_cap = to->q_cap ? to->q_cap * 2 : 64;
+        to->q = realloc(to->q, to->q_cap * sizeof *to->q);
+        if (!to->q) { perror("realloc"); exit(1); }
+    }
+    memcpy(to->q + to->q_len, h, n * sizeof *h);
+    to->q_len += n;
+    pthread_mutex_unlock(&to->lock);
+    uint64_t one = 1;
+    if (write(to->efd, &one, sizeof one) < 0) perror("eventfd");
+}
+
+/* Takes the whole queue; the caller frees it */
+static Handoff *take_inbox(Inbox *in, size_t *n) {
+    uint64_t count;
+    ssize_t r = read(in->efd, &count, sizeof count);    // EAGAIN: raced a push, take it anyway
+    (void)r;
+    pthread_mutex_lock(&in->lock);
+    Handoff *q = in->q;
+    *n = in->q_len;
+    in->q = NULL;
+    in->q_len = in->q_cap = 0;
+    pthread_mutex_unlock(&in->lock);
+    return q;
+}
+
+/* -------------------- Matchmaking -------------------- */
+static Conn **wait_list(Shard *sh, uint16_t key) {
+    return &sh->keyed[key % KEY_BUCKETS];
+}
+
+static void unwait(Shard *sh, Conn *c) {
+    if (c->variant == NO_VARIANT) return;
+    for (Conn **pp = wait_list(sh, c->key); *pp; pp = &(*pp)->wait_next) {
+        if (*pp == c) { *pp = c->wait_next; break; }
+    }
+    c->variant = NO_VARIANT;
+}
+
+static void start_game(Shard *sh, Conn *a, Conn *b, uint8_t variant) {
+    Game *g = sh->free_games;
+    if (g) sh->free_games = g->free_next;
+    else if (!(g = malloc(sizeof *g))) { fail(a); fail(b); return; }
+
+    match_start(&g->m, &sh->rng, variant_rules[variant].colors, variant_rules[variant].unique);
+    g->have = 0;
+    g->seat[0] = a;
+    g->seat[1] = b;
+    for (uint8_t p = 0; p < N_PLAYERS; p++) {
+        g->seat[p]->game = g;
+        g->seat[p]->seat = p;
+        uint8_t msg[3] = { MSG_START, p, variant };
+        send_msg(sh, g->seat[p], msg);
+    }
+    __atomic_add_fetch(&sh->active, 1, __ATOMIC_RELAXED);
+}
+
+static void end_game(Shard *sh, Game *g) {
+    for (uint8_t p = 0; p < N_PLAYERS; p++) {
+        if (g->seat[p]) g->seat[p]->game = NULL;
+    }
+    g->free_next = sh->free_games;
+    sh->free_games = g;
+    __atomic_sub_fetch(&sh->active, 1, __ATOMIC_RELAXED);
+}
+
+/* Keyed JOIN on the shard that owns the key */
+static void join(Shard *sh, Conn *c, uint8_t variant, uint16_t key) {
+    for (Conn **pp = wait_list(sh, key); *pp; pp = &(*pp)->wait_next) {
+        Conn *o = *pp;
+        if (o->variant != variant || o->key != key) continue;
+        *pp = o->wait_next;
+        o->variant = NO_VARIANT;
+        start_game(sh, o, c, variant);
+        return;
+    }
+    c->variant = variant;
+    c->key = key;
+    Conn **head = wait_list(sh, key);
+    c->wait_next = *head;
+    *head = c;
+}
+
+/* -------------------- Connections -------------------- */
+static void close_conn(Shard *sh, Conn *c) {
+    unwait(sh, c);
+    Game *g = c->game;
+    if (g) {
+        Conn *o = g->seat[c->seat ^ 1];
+        g->seat[c->seat] = NULL;
+        end_game(sh, g);
+        if (o) send_error(sh, o, PROTO_ERR_LEFT);
+    }
+    close(c->fd);
+    free(c);
+}
+
+static Conn *adopt(Shard *sh, int fd) {
+    Conn *c = calloc(1, sizeof *c);
+    if (!c) { close(fd); return NULL; }
+    c->fd = fd;
+    c->variant = NO_VARIANT;
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = c };
+    if (epoll_ctl(sh->ep, EPOLL_CTL_ADD, fd, &ev) < 0) { close(fd); free(c); return NULL; }
+    return c;
+}
+
+/* Moves a JOIN to the shard that owns its key, or a key-0 JOIN to the lobby;
+ * 1 if c has gone */
+static int route_join(Shard *sh, Conn *c, uint8_t variant, uint16_t key, size_t used) {
+    Inbox *to = key ? &shards[key % n_shards].in : &lobby.in;
+    if (to == &sh->in) return 0;
+
+    Handoff h = { .fd = c->fd, .variant = variant, .key = key };
+    h.in_len = (uint8_t)(c->in_len - used);
+    memcpy(h.in, c->in + used, h.in_len);
+    h.out_len = c->out_len;
+    memcpy(h.out, c->out, c->out_len);
+    epoll_ctl(sh->ep, EPOLL_CTL_DEL, c->fd, NULL);
+    free(c);
+    push_handoffs(to, &h, 1);
+    return 1;
+}
+
+static void on_row(Shard *sh, Conn *c, const uint8_t *packed) {
+    Game *g = c->game;
+    uint8_t bit = 1 << c->seat;
+    if (!g || (g->have & bit)) { send_error(sh, c, PROTO_ERR_MESSAGE); c->closing = 1; return; }
+
+    unpack_code(g->rows[c->seat], packed);
+    for (uint8_t i = 0; i < CODE_LEN; i++) {
+        if (g->rows[c->seat][i] > g->m.colors) { send_error(sh, c, PROTO_ERR_MESSAGE); c->closing = 1; return; }
+    }
+    g->have |= bit;
+    if (g->have != (1 << N_PLAYERS) - 1) return;
+
+    uint8_t turn = g->m.current_turn;
+    GameState state = match_commit(&g->m, g->rows[0], g->rows[1]);
+    g->have = 0;
+    __atomic_add_fetch(&sh->commits, 1, __ATOMIC_RELAXED);
+
+    for (uint8_t p = 0; p < N_PLAYERS; p++) {
+        const Turn *self = &g->m.boards[p].turns[turn];
+        const Turn *opp  = &g->m.boards[p ^ 1].turns[turn];
+        uint8_t msg[5] = { MSG_SCORE, turn, SCORE_BYTE(self->n_pos, self->n_col),
+                           SCORE_BYTE(opp->n_pos, opp->n_col), (uint8_t)state };
+        send_msg(sh, g->seat[p], msg);
+    }
+    if (state == GS_PLAYING) return;
+
+    uint8_t end[3 + CODE_PACKED] = { MSG_END, (uint8_t)state, g->m.draw_winning };
+    pack_code(end + 3, g->m.secret);
+    for (uint8_t p = 0; p < N_PLAYERS; p++) send_msg(sh, g->seat[p], end);
+    __atomic_add_fetch(&sh->matches, 1, __ATOMIC_RELAXED);
+    end_game(sh, g);
+}
+
+/* Handles every complete message in c->in; 1 if c has moved shard */
+static int on_input(Shard *sh, Conn *c) {
+    size_t used = 0;
+    while (used < c->in_len && !c->closing) {
+        uint8_t type = c->in[used], len = proto_len(type);
+        if (!len || (type != MSG_JOIN && type != MSG_ROW)) {
+            send_error(sh, c, PROTO_ERR_MESSAGE);
+            c->closing = 1;
+            break;
+        }
+        if (c->in_len - used < 1u + len) break;
+        const uint8_t *msg = c->in + used;
+        used += 1u + len;
+
+        if (type == MSG_ROW) { on_row(sh, c, msg + 1); continue; }
+
+        uint8_t variant = msg[1];
+        uint16_t key = (uint16_t)(msg[2] << 8 | msg[3]);
+        if (c->game || c->variant != NO_VARIANT) {
+            send_error(sh, c, PROTO_ERR_MESSAGE);
+            c->closing = 1;
+        } else if (!hosted(variant)) {
+            send_error(sh, c, PROTO_ERR_VARIANT);
+        } else if (route_join(sh, c, variant, key, used)) {
+            return 1;
+        } else {
+            join(sh, c, variant, key);
+        }
+    }
+    memmove(c->in, c->in + used, c->in_len - used);
+    c->in_len -= (uint8_t)used;
+    return 0;
+}
+
+/* Returns 1 if c has moved shard */
+static int on_readable(Shard *sh, Conn *c) {
+    while (!c->closing) {
+        ssize_t n = recv(c->fd, c->in + c->in_len, IN_CAP - c->in_len, 0);
+        if (n > 0) {
+            c->in_len += (uint8_t)n;
+            if (on_input(sh, c)) return 1;
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n < 0 && errno == EINTR) continue;
+        c->closing = 1;                             // EOF or error
+    }
+    return 0;
+}
+
+/* Handles what arrived before c was adopted */
+static void settle(Shard *sh, Conn *c) {
+    if (c && !on_input(sh, c) && c->closing) close_conn(sh, c);
+}
+
+static void take_handoffs(Shard *sh) {
+    size_t n;
+    Handoff *q = take_inbox(&sh->in, &n);
+    Conn *first = NULL;
+
+    for (size_t i = 0; i < n; i++) {
+        const Handoff *h = &q[i];
+        Conn *c = adopt(sh, h->fd);
+        if (c) {
+            memcpy(c->out, h->out, h->out_len);
+            c->out_len = h->out_len;
+            if (c->out_len) flush_out(sh, c);
+            memcpy(c->in, h->in, h->in_len);
+            c->in_len = h->in_len;
+        }
+
+        if (h->pair == PAIR_FIRST) {
+            first = c;
+            continue;
+        }
+        if (h->pair == PAIR_SECOND) {
+            if (first && c) start_game(sh, first, c, h->variant);
+            else if (first || c) send_error(sh, first ? first : c, PROTO_ERR_LEFT);
+            settle(sh, first);
+            first = NULL;
+        } else if (c && h->variant != NO_VARIANT) {
+            join(sh, c, h->variant, h->key);
+        }
+        settle(sh, c);
+    }
+    free(q);
+}
+
+static void *shard_main(void *arg) {
+    Shard *sh = arg;
+    struct epoll_event ev[EVENTS];
+    for (;;) {
+        int n = epoll_wait(sh->ep, ev, EVENTS, -1);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) { perror("epoll_wait"); exit(1); }
+
+        for (int i = 0; i < n; i++) {
+            Conn *c = ev[i].data.ptr;
+            if (!c) { take_handoffs(sh); continue; }
+            if (ev[i].events & EPOLLOUT) flush_out(sh, c);
+            if ((ev[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && on_readable(sh, c)) continue;
+            if (c->closing) close_conn(sh, c);
+        }
+    }
+    return NULL;
+}
+
+/* -------------------- Lobby -------------------- */
+/* The waiting player stays in the main thread's epoll so a player who
+ * leaves before being paired is noticed. A new pair is queued to one shard
+ * as PAIR_FIRST/PAIR_SECOND handoffs, and that shard starts the match. */
+static void lobby_join(int ep, const Handoff *h) {
+    Handoff *w = lobby.waiting[h->variant];
+    if (w) {
+        lobby.waiting[h->variant] = NULL;
+        epoll_ctl(ep, EPOLL_CTL_DEL, w->fd, NULL);
+        Handoff pair[2] = { *w, *h };
+        pair[0].pair = PAIR_FIRST;
+        pair[1].pair = PAIR_SECOND;
+        free(w);
+        push_handoffs(&shards[lobby.next_shard].in, pair, 2);
+        lobby.next_shard = (lobby.next_shard + 1) % n_shards;
+        return;
+    }
+
+    w = malloc(sizeof *w);
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = w };
+    if (!w || epoll_ctl(ep, EPOLL_CTL_ADD, h->fd, &ev) < 0) {
+        close(h->fd);
+        free(w);
+        return;
+    }
+    *w = *h;
+    lobby.waiting[h->variant] = w;
+}
+
+/* Bytes from a waiting player are kept for its shard */
+static void lobby_readable(int ep, Handoff *h) {
+    ssize_t n = recv(h->fd, h->in + h->in_len, IN_CAP - h->in_len, 0);
+    if (n > 0) {
+        h->in_len += (uint8_t)n;
+        if (h->in_len < IN_CAP) return;
+    } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        return;
+    }
+    /* Left, or sending more than a match could need */
+    epoll_ctl(ep, EPOLL_CTL_DEL, h->fd, NULL);
+    close(h->fd);
+    lobby.waiting[h->variant] = NULL;
+    free(h);
+}
+
+static void lobby_take(int ep) {
+    size_t n;
+    Handoff *q = take_inbox(&lobby.in, &n);
+    for (size_t i = 0; i < n; i++) lobby_join(ep, &q[i]);
+    free(q);
+}
+
+/* -------------------- Accept -------------------- */
+/* Out of descriptors, the listener stays readable and epoll would report it
+ * again at once. A spare descriptor is given up to accept and close pending
+ * connections instead; if it cannot be reopened the listener is left out of
+ * epoll for a second. */
+static int reserve_fd = -1;
+static unsigned long shed;                          // connections closed unserved
+
+/* Returns 1 if the listener should be paused */
+static int accept_conns(int lfd) {
+    static int next;
+    int one = 1;
+    for (;;) {
+        int fd = accept4(lfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd >= 0) {
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+            Handoff h = { .fd = fd, .variant = NO_VARIANT };
+            push_handoffs(&shards[next].in, &h, 1);
+            next = (next + 1) % n_shards;
+            continue;
+        }
+        if (errno == EINTR || errno == ECONNABORTED) continue;
+        if (errno != EMFILE && errno != ENFILE) return 0;  // backlog empty
+        if (reserve_fd < 0) return 1;
+
+        close(reserve_fd);
+        fd = accept4(lfd, NULL, NULL, SOCK_CLOEXEC);
+        int err = errno;
+        if (fd >= 0) {
+            close(fd);
+            shed++;
+        }
+        reserve_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+        if (reserve_fd < 0 || (fd < 0 && (err == EMFILE || err == ENFILE))) return 1;
+        if (fd < 0) return 0;
+    }
+}
+
+/* -------------------- Main -------------------- */
+static void init_shard(Shard *sh, int id) {
+    sh->id = id;
+    sh->ep = epoll_create1(EPOLL_CLOEXEC);
+    if (sh->ep < 0) { perror("epoll_create1"); exit(1); }
+    init_inbox(&sh->in);
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = NULL };
+    epoll_ctl(sh->ep, EPOLL_CTL_ADD, sh->in.efd, &ev);
+
+    uint8_t seed[4];
+    if (getrandom(seed, sizeof seed, 0) != sizeof seed) { perror("getrandom"); exit(1); }
+    sh->rng = (Rng){ seed[0], seed[1], seed[2], seed[3] };
+    rng_stir(&sh->rng, 0);                          // never all zero
+}
+
+int main(int argc, char **argv) {
+    int port = PROTO_PORT, quiet = 0;
+    n_shards = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "p:t:q")) != -1) {
+        switch (opt) {
+        case 'p': port = atoi(optarg); break;
+        case 't': n_shards = atoi(optarg); break;
+        case 'q': quiet = 1; break;
+        default:
+            fprintf(stderr, "usage: %s [-p port] [-t threads] [-q]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (n_shards < 1) n_shards = 1;
+    if (n_shards > MAX_SHARDS) n_shards = MAX_SHARDS;
+
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    int lfd = socket(AF_INET6, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int zero = 0, one = 1;
+    setsockopt(lfd, IPPROTO_IPV6, IPV6_V6ONLY, &zero, sizeof zero);
+    setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+    struct sockaddr_in6 addr = { .sin6_family = AF_INET6, .sin6_port = htons((uint16_t)port),
+                                 .sin6_addr = IN6ADDR_ANY_INIT };
+    if (lfd < 0 || bind(lfd, (struct sockaddr *)&addr, sizeof addr) < 0 || listen(lfd, SOMAXCONN) < 0) {
+        perror("listen");
+        return 1;
+    }
+
+    init_inbox(&lobby.in);
+    for (int i = 0; i < n_shards; i++) {
+        init_shard(&shards[i], i);
+        pthread_create(&shards[i].thread, NULL, shard_main, &shards[i]);
+    }
+    fprintf(stderr, "listening on port %d with %d shards\n", port, n_shards);
+
+    /* The main thread accepts, and runs the lobby */
+    reserve_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    int ep = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event lev = { .events = EPOLLIN, .data.ptr = NULL };
+    struct epoll_event iev = { .events = EPOLLIN, .data.ptr = &lobby.in };
+    if (ep < 0 || epoll_ctl(ep, EPOLL_CTL_ADD, lfd, &lev) < 0 ||
+        epoll_ctl(ep, EPOLL_CTL_ADD, lobby.in.efd, &iev) < 0) {
+        perror("epoll");
+        return 1;
+    }
+
+    uint64_t last_matches = 0;
+    unsigned long last_shed = 0;
+    time_t last_report = time(NULL), paused_until = 0;
+    struct epoll_event ev[EVENTS];
+    for (;;) {
+        int n = epoll_wait(ep, ev, EVENTS, 1000);
+        if (n < 0 && errno != EINTR) { perror("epoll_wait"); return 1; }
+        for (int i = 0; i < n; i++) {
+            if (ev[i].data.ptr == &lobby.in) {
+                lobby_take(ep);
+            } else if (ev[i].data.ptr) {
+                lobby_readable(ep, ev[i].data.ptr);
+            } else if (!paused_until && accept_conns(lfd)) {
+                fprintf(stderr, "out of descriptors, accepting again in a second\n");
+                epoll_ctl(ep, EPOLL_CTL_DEL, lfd, NULL);
+                paused_until = time(NULL) + 1;
+            }
+        }
+
+        time_t now = time(NULL);
+        if (paused_until && now >= paused_until) {
+            if (reserve_fd < 0) reserve_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+            epoll_ctl(ep, EPOLL_CTL_ADD, lfd, &lev);
+            paused_until = 0;
+        }
+        if (quiet || now - last_report < 5) continue;
+        uint64_t matches = 0, commits = 0;
+        uint32_t active = 0, lo = UINT32_MAX, hi = 0;
+        for (int i = 0; i < n_shards; i++) {
+            uint32_t a = __atomic_load_n(&shards[i].active, __ATOMIC_RELAXED);
+            matches += __atomic_load_n(&shards[i].matches, __ATOMIC_RELAXED);
+            commits += __atomic_load_n(&shards[i].commits, __ATOMIC_RELAXED);
+            active += a;
+            if (a < lo) lo = a;
+            if (a > hi) hi = a;
+        }
+        if (matches != last_matches || active)
+            fprintf(stderr, "matches %llu (%.0f/s), commits %llu, active %u (%u..%u per shard)\n",
+                    (unsigned long long)matches, (double)(matches - last_matches) / (now - last_report),
+                    (unsigned long long)commits, active, lo, hi);
+        if (shed != last_shed)
+            fprintf(stderr, "out of descriptors: %lu connections closed unserved\n", shed - last_shed);
+        last_matches = matches;
+        last_shed = shed;
+        last_report = now;
+    }
+}
@@ -0,0 +1,159 @@
+/*
+ * Host statistics for the secret generator in rng.h.
+ *
+ * Generates secrets with draw_secret() from engine.h for each variant and
+ * reports ns and, on x86, TSC cycles per secret, xorshift draws per secret
+ * and two chi-square tests: colours per peg and whole secrets. z is the
+ * Wilson-Hilferty normal approximation of chi2 with dof degrees of freedom;
+ * a test fails when |z| > Z_LIMIT, too uneven or too even to be random.
+ * Exits with status 1 if any test failed.
+ *
+ *   rng_stats [secrets] [seed]
+ *
+ * Defaults: 1000000 secrets, seed 1.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+#include "../engine.h"
+
+#define MAX_COLORS  7                   // whole[] packs 3 bits per peg
+#define Z_LIMIT     4.0                 // two-sided, about 6e-5 per test by chance
+
+#define VARIANT_FITS(id, colors, unique, turn_s) \
+    _Static_assert(colors <= MAX_COLORS, "VARIANT_" #id " does not fit 3 bits per peg");
+VARIANTS(VARIANT_FITS)
+
+#define VARIANT_NAME(id, colors, unique, turn_s) #id,
+static const char *const variant_name[VARIANT_COUNT] = { VARIANTS(VARIANT_NAME) };
+
+static uint32_t draws;
+
+static int same(const Rng *a, const Rng *b) {
+    return a->x == b->x && a->y == b->y && a->z == b->z && a->w == b->w;
+}
+
+/* Same loop as draw_secret(), counting generator steps */
+static void secret(Rng *state, const VariantRules *r, uint8_t out[CODE_LEN]) {
+    uint8_t used = 0;
+    for (int i = 0; i < CODE_LEN; i++) {
+        uint8_t c;
+        do {
+            Rng s = *state;
+            c = rng_below(state, r->colors) + 1;
+            for (; !same(&s, state); xorshift8(&s)) draws++;
+        } while (r->unique && (used & (1 << c)));
+        used |= 1 << c;
+        out[i] = c;
+    }
+}
+
+static double chi2(const uint32_t *count, uint32_t bins, double expect) {
+    double x = 0;
+    for (uint32_t i = 0; i < bins; i++) {
+        if (!expect) continue;
+        double d = count[i] - expect;
+        x += d * d / expect;
+    }
+    return x;
+}
+
+/* Prints one test; returns 1 if it failed */
+static int report(const char *what, double x, uint32_t dof) {
+    double v = 2.0 / (9.0 * dof);
+    double z = (cbrt(x / dof) - (1.0 - v)) / sqrt(v);
+    int fail = fabs(z) > Z_LIMIT;
+    printf("  %-8s chi2 %10.1f  dof %5u  z %+6.2f  %s\n", what, x, dof, z, fail ? "FAIL" : "ok");
+    return fail;
+}
+
+int main(int argc, char **argv) {
+    unsigned long n = argc > 1 ? strtoul(argv[1], NULL, 0) : 1000000;
+    uint16_t seed = argc > 2 ? (uint16_t)strtoul(argv[2], NULL, 0) : 1;
+    if (!n) {
+        fprintf(stderr, "usage: %s [secrets > 0] [seed]\n", argv[0]);
+        return 2;
+    }
+
+    static uint32_t whole[1u << (3 * CODE_LEN)];
+    int failed = 0;
+    for (int v = 0; v < VARIANT_COUNT; v++) {
+        const VariantRules *r = &variant_rules[v];
+        uint32_t peg[CODE_LEN][MAX_COLORS + 1];
+        memset(peg, 0, sizeof peg);
+        memset(whole, 0, sizeof whole);
+
+        /* Timing run without the draw counting */
+        Rng state = { 0, 0, 0, 0 };
+        rng_stir(&state, seed);
+        Rng start = state;
+        uint8_t code[CODE_LEN];
+        struct timespec t0, t1;
+#if HAVE_TSC
+        uint64_t c0 = __rdtsc();
+#endif
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (unsigned long k = 0; k < n; k++) {
+            draw_secret(code, &state, r->colors, r->unique);
+            whole[0] += code[0];        // keep the loop from being optimised out
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+#if HAVE_TSC
+        double cycles = (double)(__rdtsc() - c0) / n;
+#else
+        double cycles = 0;
+#endif
+        double ns = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / n;
+        whole[0] = 0;
+
+        state = start;
+        draws = 0;
+        for (unsigned long k = 0; k < n; k++) {
+            secret(&state, r, code);
+            uint32_t idx = 0;
+            for (int i = 0; i < CODE_LEN; i++) {
+                peg[i][code[i]]++;
+                idx = idx << 3 | code[i];
+            }
+            whole[idx]++;
+        }
+
+        /* Possible secrets: colors^CODE_LEN, or the ordered picks when unique */
+        uint32_t n_secrets = 1;
+        for (int i = 0; i < CODE_LEN; i++) n_secrets *= r->unique ? (uint32_t)(r->colors - i) : r->colors;
+
+        printf("%s: %.1f ns/secret", variant_name[v], ns);
+        if (cycles) printf(", %.1f cycles/secret", cycles);
+        printf(", %.3f draws/secret\n", (double)draws / n);
+        uint32_t flat[CODE_LEN * MAX_COLORS];
+        for (int i = 0; i < CODE_LEN; i++)
+            for (int c = 0; c < r->colors; c++) flat[i * r->colors + c] = peg[i][c + 1];
+        double x = 0;
+        for (int i = 0; i < CODE_LEN; i++) x += chi2(&flat[i * r->colors], r->colors, (double)n / r->colors);
+        failed |= report("per peg", x, CODE_LEN * (r->colors - 1));
+
+        uint32_t *hits = malloc(n_secrets * sizeof *hits), m = 0;
+        for (uint32_t idx = 0; idx < (1u << (3 * CODE_LEN)); idx++) {
+            int ok = 1;
+            uint8_t used = 0;
+            for (int i = 0; i < CODE_LEN; i++) {
+                uint8_t c = (idx >> (3 * i)) & 7;
+                if (c < 1 || c > r->colors || (r->unique && (used & (1 << c)))) ok = 0;
+                used |= 1 << c;
+            }
+            if (ok) hits[m++] = whole[idx];
+        }
+        failed |= report("secrets", chi2(hits, m, (double)n / n_secrets), n_secrets - 1);
+        free(hits);
+    }
+    return failed;
+}
@@ -9,6 +9,7 @@
 * Nov 11, 2023  v2.5  Added support for ports that cannot be addressed with "out"
 *                       Added LGT8F88A support
 * May 1, 2024   v2.6 Added support for reduced core AVRs
+*               Logik: ws2812_setleds_lut (gamma LUT + dithering per byte)
 *
 * License: GNU GPL v2+ (see License.txt)
 */
@@ -16,6 +17,7 @@
 #include "light_ws2812.h"
 #include <avr/interrupt.h>
 #include <avr/io.h>
+#include <avr/pgmspace.h>
 #include <util/delay.h>
  
 // Setleds for standard RGB 
@@ -30,6 +32,13 @@ void inline ws2812_setleds_pin(struct cRGB *ledarray, uint16_t leds, uint8_t pin
   _delay_us(ws2812_resettime);
 }
 
+// Setleds through a brightness/gamma LUT with temporal dithering
+void inline ws2812_setleds_lut(struct cRGB *ledarray, uint16_t leds, const uint16_t *lut, uint8_t dither)
+{
+  ws2812_sendarray_lut((uint8_t*)ledarray,leds+leds+leds,_BV(ws2812_pin),lut,dither);
+  _delay_us(ws2812_resettime);
+}
+
 // Setleds for SK6812RGBW
 void inline ws2812_setleds_rgbw(struct cRGBW *ledarray, uint16_t leds)
 {
@@ -118,7 +127,13 @@ void ws2812_sendarray(uint8_t *data,uint16_t datlen)
 #define w_nop8  w_nop4 w_nop4
 #define w_nop16 w_nop8 w_nop8
 
-void inline ws2812_sendarray_mask(uint8_t *data,uint16_t datlen,uint8_t maskhi)
+// With a LUT, every byte is replaced by the integer part of its 8.8 entry,
+// rounded up when the fraction exceeds a threshold that advances per byte.
+// That adds about 15 cycles (~1 us at 16 MHz) of low time between bytes,
+// well inside the 50 us reset threshold.
+
+static inline __attribute__((always_inline))
+void ws2812_send_core(uint8_t *data,uint16_t datlen,uint8_t maskhi,const uint16_t *lut,uint8_t dither)
 {
   // `maskhi` is 0x80 if P?7 is LED DATA
   uint8_t curbyte,ctr,masklo;
@@ -142,6 +157,11 @@ void inline ws2812_sendarray_mask(uint8_t *data,uint16_t datlen,uint8_t maskhi)
 
   while (datlen--) {
     curbyte=*data++;
+    if (lut) {
+      uint16_t level=pgm_read_word(&lut[curbyte]);
+      curbyte=(level>>8)+((uint8_t)level>dither);
+      dither+=WS2812_DITHER_STEP;
+    }
     
     __asm__ volatile(
     "       ldi   %0,8  \n\t"
@@ -240,4 +260,14 @@ w_nop16
   sei();  
 #endif
 
-}
\ No newline at end of file
+}
+
+void ws2812_sendarray_mask(uint8_t *data,uint16_t datlen,uint8_t maskhi)
+{
+  ws2812_send_core(data,datlen,maskhi,0,0);
+}
+
+void ws2812_sendarray_lut(uint8_t *data,uint16_t datlen,uint8_t maskhi,const uint16_t *lut,uint8_t dither)
+{
+  ws2812_send_core(data,datlen,maskhi,lut,dither);
+}
@@ -78,11 +78,21 @@ extern "C" {
  *         - Set the data-out pin as output
  *         - Send out the LED data 
  *         - Wait 50µs to reset the LEDs
+ *
+ * ws2812_setleds_lut sends every byte through lut (PROGMEM, 8.8 fixed point,
+ * integer part at most 254): the integer part goes out, plus one when the
+ * fraction beats a per-byte threshold seeded by dither. Varying dither from
+ * frame to frame dithers sub-LSB levels over time.
+ *
+ * The threshold advances by WS2812_DITHER_STEP per byte; callers advance
+ * dither by the same step per frame.
  */
+#define WS2812_DITHER_STEP 0x9E     // 256 / golden ratio: thresholds spread evenly
 
 void ws2812_setleds     (struct cRGB  *ledarray, uint16_t number_of_leds);
 void ws2812_setleds_pin (struct cRGB  *ledarray, uint16_t number_of_leds,uint8_t pinmask);
 void ws2812_setleds_rgbw(struct cRGBW *ledarray, uint16_t number_of_leds);
+void ws2812_setleds_lut (struct cRGB  *ledarray, uint16_t number_of_leds,const uint16_t *lut,uint8_t dither);
 
 /* 
  * Old interface / Internal functions
@@ -93,6 +103,7 @@ void ws2812_setleds_rgbw(struct cRGBW *ledarray, uint16_t number_of_leds);
 
 void ws2812_sendarray     (uint8_t *array,uint16_t length);
 void ws2812_sendarray_mask(uint8_t *array,uint16_t length, uint8_t pinmask);
+void ws2812_sendarray_lut (uint8_t *array,uint16_t length, uint8_t pinmask,const uint16_t *lut,uint8_t dither);
 
 #ifdef __cplusplus
 }